@@ -7,3 +7,9 @@ SUBDIRS = \
 
 demo.depends = src
 example.depends = src
+
+# Build the layout benchmarks with qmake CONFIG+=adsBuildBenchmarks
+adsBuildBenchmarks {
+	SUBDIRS += benchmark
+	benchmark.depends = src
+}
@@ -0,0 +1,448 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   LayoutBenchmark.cpp
+/// \date   14.10.2026
+/// \brief  Benchmarks for the layout operations of the docking system
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include <QtTest>
+#include <QMainWindow>
+#include <QLabel>
+#include <QLoggingCategory>
+
+#include "DockManager.h"
+#include "DockContainerWidget.h"
+#include "DockAreaWidget.h"
+#include "DockWidget.h"
+#include "DockOverlay.h"
+
+
+/**
+ * Dock manager that gives the benchmark access to the protected functions
+ * that are used while a floating widget is dragged
+ */
+class CBenchmarkDockManager : public ads::CDockManager
+{
+public:
+	using ads::CDockManager::CDockManager;
+	using ads::CDockManager::dockContainerAt;
+	using ads::CDockManager::containerOverlay;
+	using ads::CDockManager::dockAreaOverlay;
+};
+
+
+/**
+ * Benchmarks for saving, restoring and modifying synthetic layouts with
+ * a configurable number of dock widgets and dock areas.
+ * Run the benchmark executable with -help to see the QTest options, i.e.
+ * -iterations or -callgrind
+ */
+class CLayoutBenchmark : public QObject
+{
+	Q_OBJECT
+private:
+	QMainWindow* MainWindow = nullptr;
+	CBenchmarkDockManager* DockManager = nullptr;
+
+	void createDockManager(ads::CDockManager::ConfigFlags Flags);
+	void createLayout(int WidgetCount, int AreaCount);
+	void addLayoutData();
+	void addStateFormatData();
+
+private slots:
+	void initTestCase();
+	void cleanup();
+
+	void saveState_data();
+	void saveState();
+	void restoreState_data();
+	void restoreState();
+	void openPerspective_data();
+	void openPerspective();
+	void addDockWidget_data();
+	void addDockWidget();
+	void removeDockArea_data();
+	void removeDockArea();
+	void switchTabs_data();
+	void switchTabs();
+	void updateDropOverlays_data();
+	void updateDropOverlays();
+};
+
+
+//============================================================================
+void CLayoutBenchmark::createDockManager(ads::CDockManager::ConfigFlags Flags)
+{
+	MainWindow = new QMainWindow();
+	MainWindow->resize(1600, 1000);
+	DockManager = new CBenchmarkDockManager(MainWindow);
+	DockManager->setConfigFlags(Flags);
+}
+
+
+//============================================================================
+void CLayoutBenchmark::createLayout(int WidgetCount, int AreaCount)
+{
+	// The first AreaCount dock widgets create new dock areas that are
+	// alternately split horizontally and vertically. All other dock widgets
+	// are distributed as tabs over the created dock areas
+	QVector<ads::CDockAreaWidget*> DockAreas;
+	for (int i = 0; i < WidgetCount; ++i)
+	{
+		auto DockWidget = new ads::CDockWidget(QString("DockWidget%1").arg(i));
+		DockWidget->setWidget(new QLabel(DockWidget->objectName()));
+		if (i < AreaCount)
+		{
+			auto Area = (i % 2) ? ads::BottomDockWidgetArea : ads::RightDockWidgetArea;
+			DockAreas.append(DockManager->addDockWidget(Area, DockWidget,
+				DockAreas.isEmpty() ? nullptr : DockAreas.last()));
+		}
+		else
+		{
+			DockManager->addDockWidgetTabToArea(DockWidget, DockAreas[i % AreaCount]);
+		}
+	}
+}
+
+
+//============================================================================
+void CLayoutBenchmark::addLayoutData()
+{
+	QTest::addColumn<int>("WidgetCount");
+	QTest::addColumn<int>("AreaCount");
+
+	QTest::newRow("10 widgets, 4 areas") << 10 << 4;
+	QTest::newRow("100 widgets, 10 areas") << 100 << 10;
+	QTest::newRow("500 widgets, 50 areas") << 500 << 50;
+}
+
+
+//============================================================================
+void CLayoutBenchmark::addStateFormatData()
+{
+	QTest::addColumn<int>("WidgetCount");
+	QTest::addColumn<int>("AreaCount");
+	QTest::addColumn<int>("Flags");
+
+	const int Xml = ads::CDockManager::DefaultConfig & ~ads::CDockManager::XmlCompressionEnabled;
+	const int CompressedXml = ads::CDockManager::DefaultConfig | ads::CDockManager::XmlCompressionEnabled;
+	const int Binary = ads::CDockManager::DefaultConfig | ads::CDockManager::BinaryStateFormat;
+	const int Sizes[][2] = {{10, 4}, {100, 10}, {500, 50}};
+	for (const auto& Size : Sizes)
+	{
+		QString Layout = QString("%1 widgets, %2 areas").arg(Size[0]).arg(Size[1]);
+		QTest::newRow(qPrintable(Layout + ", xml")) << Size[0] << Size[1] << Xml;
+		QTest::newRow(qPrintable(Layout + ", compressed xml")) << Size[0] << Size[1] << CompressedXml;
+		QTest::newRow(qPrintable(Layout + ", binary")) << Size[0] << Size[1] << Binary;
+	}
+}
+
+
+//============================================================================
+void CLayoutBenchmark::initTestCase()
+{
+	// The library prints a lot of debug output that would dominate the
+	// measured times
+	QLoggingCategory::setFilterRules("*.debug=false");
+}
+
+
+//============================================================================
+void CLayoutBenchmark::cleanup()
+{
+	delete MainWindow;
+	MainWindow = nullptr;
+	DockManager = nullptr;
+}
+
+
+//============================================================================
+void CLayoutBenchmark::saveState_data()
+{
+	addStateFormatData();
+}
+
+
+//============================================================================
+void CLayoutBenchmark::saveState()
+{
+	QFETCH(int, WidgetCount);
+	QFETCH(int, AreaCount);
+	QFETCH(int, Flags);
+	createDockManager(ads::CDockManager::ConfigFlags(Flags));
+	createLayout(WidgetCount, AreaCount);
+
+	QByteArray State;
+	QBENCHMARK
+	{
+		State = DockManager->saveState();
+	}
+	QVERIFY(!State.isEmpty());
+}
+
+
+//============================================================================
+void CLayoutBenchmark::restoreState_data()
+{
+	addStateFormatData();
+}
+
+
+//============================================================================
+void CLayoutBenchmark::restoreState()
+{
+	QFETCH(int, WidgetCount);
+	QFETCH(int, AreaCount);
+	QFETCH(int, Flags);
+	createDockManager(ads::CDockManager::ConfigFlags(Flags));
+	createLayout(WidgetCount, AreaCount);
+	QByteArray State = DockManager->saveState();
+
+	bool Restored = false;
+	QBENCHMARK
+	{
+		Restored = DockManager->restoreState(State);
+	}
+	QVERIFY(Restored);
+}
+
+
+//============================================================================
+void CLayoutBenchmark::openPerspective_data()
+{
+	addLayoutData();
+}
+
+
+//============================================================================
+void CLayoutBenchmark::openPerspective()
+{
+	QFETCH(int, WidgetCount);
+	QFETCH(int, AreaCount);
+	createDockManager(ads::CDockManager::DefaultConfig);
+	createLayout(WidgetCount, AreaCount);
+	DockManager->addPerspective("Initial");
+
+	// The second perspective moves every dock widget into its own dock area
+	// so that switching between both perspectives changes the complete layout
+	const auto DockWidgets = DockManager->dockWidgets();
+	for (auto DockWidget : DockWidgets)
+	{
+		DockManager->addDockWidget(ads::LeftDockWidgetArea, DockWidget);
+	}
+	DockManager->addPerspective("Split");
+
+	bool Initial = true;
+	QBENCHMARK
+	{
+		DockManager->openPerspective(Initial ? "Initial" : "Split");
+		Initial = !Initial;
+	}
+}
+
+
+//============================================================================
+void CLayoutBenchmark::addDockWidget_data()
+{
+	QTest::addColumn<int>("WidgetCount");
+	QTest::addColumn<int>("AreaCount");
+	QTest::addColumn<bool>("Batched");
+
+	QTest::newRow("100 widgets, 10 areas") << 100 << 10 << false;
+	QTest::newRow("100 widgets, 10 areas, batched") << 100 << 10 << true;
+	QTest::newRow("500 widgets, 50 areas") << 500 << 50 << false;
+	QTest::newRow("500 widgets, 50 areas, batched") << 500 << 50 << true;
+}
+
+
+//============================================================================
+void CLayoutBenchmark::addDockWidget()
+{
+	QFETCH(int, WidgetCount);
+	QFETCH(int, AreaCount);
+	QFETCH(bool, Batched);
+
+	// Each iteration needs a fresh dock manager, so the creation of the
+	// empty dock manager is part of the measured time
+	QBENCHMARK
+	{
+		cleanup();
+		createDockManager(ads::CDockManager::DefaultConfig);
+		if (Batched)
+		{
+			ads::CDockManagerUpdateGuard Guard(DockManager);
+			createLayout(WidgetCount, AreaCount);
+		}
+		else
+		{
+			createLayout(WidgetCount, AreaCount);
+		}
+	}
+	QCOMPARE(DockManager->dockWidgets().count(), WidgetCount);
+}
+
+
+//============================================================================
+void CLayoutBenchmark::removeDockArea_data()
+{
+	addLayoutData();
+}
+
+
+//============================================================================
+void CLayoutBenchmark::removeDockArea()
+{
+	QFETCH(int, WidgetCount);
+	QFETCH(int, AreaCount);
+	createDockManager(ads::CDockManager::DefaultConfig);
+	createLayout(WidgetCount, AreaCount);
+
+	// Removing the last dock widget of a dock area removes the dock area
+	// from its container. The layout is destroyed by the measurement, so it
+	// can only be measured once
+	QList<ads::CDockWidget*> RemovedDockWidgets;
+	QBENCHMARK_ONCE
+	{
+		while (DockManager->dockAreaCount())
+		{
+			auto DockArea = DockManager->dockArea(0);
+			for (auto DockWidget : DockArea->dockWidgets())
+			{
+				DockManager->removeDockWidget(DockWidget);
+				RemovedDockWidgets.append(DockWidget);
+			}
+			QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+		}
+	}
+	QCOMPARE(RemovedDockWidgets.count(), WidgetCount);
+	qDeleteAll(RemovedDockWidgets);
+}
+
+
+//============================================================================
+void CLayoutBenchmark::switchTabs_data()
+{
+	addLayoutData();
+}
+
+
+//============================================================================
+void CLayoutBenchmark::switchTabs()
+{
+	QFETCH(int, WidgetCount);
+	QFETCH(int, AreaCount);
+	createDockManager(ads::CDockManager::DefaultConfig);
+	createLayout(WidgetCount, AreaCount);
+	MainWindow->show();
+	QVERIFY(QTest::qWaitForWindowExposed(MainWindow));
+
+	QBENCHMARK
+	{
+		for (int i = 0; i < DockManager->dockAreaCount(); ++i)
+		{
+			auto DockArea = DockManager->dockArea(i);
+			for (int Index = 0; Index < DockArea->dockWidgetsCount(); ++Index)
+			{
+				DockArea->setCurrentIndex(Index);
+			}
+		}
+	}
+}
+
+
+//============================================================================
+void CLayoutBenchmark::updateDropOverlays_data()
+{
+	addLayoutData();
+}
+
+
+//============================================================================
+void CLayoutBenchmark::updateDropOverlays()
+{
+	QFETCH(int, WidgetCount);
+	QFETCH(int, AreaCount);
+	createDockManager(ads::CDockManager::DefaultConfig);
+	createLayout(WidgetCount, AreaCount);
+	MainWindow->show();
+	QVERIFY(QTest::qWaitForWindowExposed(MainWindow));
+
+	// Simulates the drop overlay updates of a floating widget that is
+	// dragged diagonally over the complete dock manager. This is the same
+	// sequence of calls that the floating widget does for each mouse move
+	auto ContainerOverlay = DockManager->containerOverlay();
+	auto DockAreaOverlay = DockManager->dockAreaOverlay();
+	const QRect Rect(DockManager->mapToGlobal(QPoint(0, 0)), DockManager->size());
+	const int Steps = 100;
+	QBENCHMARK
+	{
+		for (int i = 0; i < Steps; ++i)
+		{
+			QPoint GlobalPos(Rect.left() + Rect.width() * i / Steps,
+				Rect.top() + Rect.height() * i / Steps);
+			auto TopContainer = DockManager->dockContainerAt(GlobalPos);
+			if (!TopContainer)
+			{
+				ContainerOverlay->hideOverlay();
+				DockAreaOverlay->hideOverlay();
+				continue;
+			}
+
+			int VisibleDockAreas = TopContainer->visibleDockAreaCount();
+			ContainerOverlay->setAllowedAreas(VisibleDockAreas > 1 ?
+				ads::OuterDockAreas : ads::AllDockAreas);
+			auto ContainerArea = ContainerOverlay->showOverlay(TopContainer, GlobalPos);
+			ContainerOverlay->enableDropPreview(ContainerArea != ads::InvalidDockWidgetArea);
+			auto DockArea = TopContainer->dockAreaAt(GlobalPos);
+			if (DockArea && DockArea->isVisible() && VisibleDockAreas > 0)
+			{
+				DockAreaOverlay->enableDropPreview(true);
+				DockAreaOverlay->setAllowedAreas((VisibleDockAreas == 1) ?
+					ads::NoDockWidgetArea : ads::AllDockAreas);
+				auto Area = DockAreaOverlay->showOverlay(DockArea, GlobalPos);
+				if ((Area == ads::CenterDockWidgetArea)
+				 && (ContainerArea != ads::InvalidDockWidgetArea))
+				{
+					DockAreaOverlay->enableDropPreview(false);
+					ContainerOverlay->enableDropPreview(true);
+				}
+				else
+				{
+					ContainerOverlay->enableDropPreview(ads::InvalidDockWidgetArea == Area);
+				}
+			}
+			else
+			{
+				DockAreaOverlay->hideOverlay();
+			}
+		}
+	}
+	ContainerOverlay->hideOverlay();
+	DockAreaOverlay->hideOverlay();
+}
+
+
+QTEST_MAIN(CLayoutBenchmark)
+#include "LayoutBenchmark.moc"
@@ -0,0 +1,39 @@
+ADS_OUT_ROOT = $${OUT_PWD}/..
+
+QT += core gui widgets testlib
+
+TARGET = LayoutBenchmark
+DESTDIR = $${ADS_OUT_ROOT}/lib
+TEMPLATE = app
+CONFIG += c++14
+CONFIG += debug_and_release
+CONFIG += console testcase no_testcase_installs
+adsBuildStatic {
+    DEFINES += ADS_STATIC
+}
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        LayoutBenchmark.cpp
+
+LIBS += -L$${ADS_OUT_ROOT}/lib
+
+# Dependency: AdvancedDockingSystem (shared)
+CONFIG(debug, debug|release){
+    win32 {
+        LIBS += -lqtadvanceddockingd
+    }
+    else:mac {
+        LIBS += -lqtadvanceddocking_debug
+    }
+    else {
+        LIBS += -lqtadvanceddocking
+    }
+}
+else{
+    LIBS += -lqtadvanceddocking
+}
+
+INCLUDEPATH += ../src
+DEPENDPATH += ../src    
@@ -34,8 +34,11 @@
 #include <QDebug>
 #include <QBoxLayout>
 #include <QApplication>
+#include <QPointer>
+#include <QTimer>
 
 #include "FloatingDockContainer.h"
+#include "FloatingDragPreview.h"
 #include "DockAreaWidget.h"
 #include "DockOverlay.h"
 #include "DockManager.h"
@@ -47,6 +50,20 @@
 
 namespace ads
 {
+/**
+ * Lightweight descriptor of a tab in the tab bar.
+ * In virtualized mode, tabs that are far outside of the visible viewport
+ * are not realized. They are parked in a hidden widget and the tabs layout
+ * contains a fixed size spacer of the estimated tab width instead.
+ */
+struct TabDescriptor
+{
+	CDockWidgetTab* Tab = nullptr;
+	bool Realized = true;
+	int Width = 0;
+};
+
+
 /**
  * Private data class of CDockAreaTabBar class (pimpl)
  */
@@ -55,10 +72,16 @@ struct DockAreaTabBarPrivate
 	CDockAreaTabBar* _this;
 	QPoint DragStartMousePos;
 	CDockAreaWidget* DockArea;
-	CFloatingDockContainer* FloatingWidget = nullptr;
+	IFloatingWidget* FloatingWidget = nullptr;
 	QWidget* TabsContainerWidget;
 	QBoxLayout* TabsLayout;
 	int CurrentIndex = -1;
+	QPointer<CDockWidgetTab> ActiveTab;
+	QVector<TabDescriptor> Tabs;
+	bool Virtualized = false;
+	bool Realizing = false;
+	QWidget* ParkingWidget = nullptr;
+	QTimer* RealizeTimer = nullptr;
 
 	/**
 	 * Private data constructor
@@ -67,9 +90,50 @@ struct DockAreaTabBarPrivate
 
 	/**
 	 * Update tabs after current index changed or when tabs are removed.
-	 * The function reassigns the stylesheet to update the tabs
+	 * Only the previously active tab and the new current tab are touched,
+	 * so switching tabs does not depend on the number of tabs
 	 */
 	void updateTabs();
+
+	/**
+	 * Returns the descriptor index of the given tab or -1 if the tab is not
+	 * in this tab bar
+	 */
+	int indexOf(CDockWidgetTab* Tab) const;
+
+	/**
+	 * Returns the width the given tab occupies in the tabs layout
+	 */
+	int tabWidth(const TabDescriptor& Descriptor) const;
+
+	/**
+	 * Moves the tab with the given index from the parking widget into the
+	 * tabs layout
+	 */
+	void realizeTab(int Index);
+
+	/**
+	 * Moves the tab with the given index from the tabs layout into the
+	 * parking widget and replaces it by a spacer item
+	 */
+	void parkTab(int Index);
+
+	/**
+	 * Realizes all open tabs in the visible viewport plus a margin of one
+	 * viewport width on each side and parks all other tabs
+	 */
+	void updateRealizedTabs();
+
+	/**
+	 * Schedules an update of the realized tabs in virtualized mode
+	 */
+	void scheduleRealizedTabsUpdate()
+	{
+		if (RealizeTimer)
+		{
+			RealizeTimer->start();
+		}
+	}
 };
 // struct DockAreaTabBarPrivate
 
@@ -84,29 +148,130 @@ DockAreaTabBarPrivate::DockAreaTabBarPrivate(CDockAreaTabBar* _public) :
 //============================================================================
 void DockAreaTabBarPrivate::updateTabs()
 {
-	// Set active TAB and update all other tabs to be inactive
-	for (int i = 0; i < _this->count(); ++i)
+	auto CurrentTab = _this->tab(CurrentIndex);
+	if (ActiveTab && ActiveTab != CurrentTab)
+	{
+		ActiveTab->setActiveTab(false);
+	}
+
+	ActiveTab = CurrentTab;
+	if (CurrentTab)
+	{
+		realizeTab(CurrentIndex);
+		CurrentTab->show();
+		CurrentTab->setActiveTab(true);
+		_this->ensureWidgetVisible(CurrentTab);
+	}
+	scheduleRealizedTabsUpdate();
+}
+
+
+//============================================================================
+int DockAreaTabBarPrivate::indexOf(CDockWidgetTab* Tab) const
+{
+	for (int i = 0; i < Tabs.count(); ++i)
 	{
-		auto TabWidget = _this->tab(i);
-		if (!TabWidget)
+		if (Tabs[i].Tab == Tab)
 		{
-			continue;
+			return i;
 		}
+	}
+
+	return -1;
+}
+
+
+//============================================================================
+int DockAreaTabBarPrivate::tabWidth(const TabDescriptor& Descriptor) const
+{
+	if (Descriptor.Tab->isHidden())
+	{
+		return 0;
+	}
+
+	return Descriptor.Realized ? Descriptor.Tab->sizeHint().width() : Descriptor.Width;
+}
+
+
+//============================================================================
+void DockAreaTabBarPrivate::realizeTab(int Index)
+{
+	TabDescriptor& Descriptor = Tabs[Index];
+	if (Descriptor.Realized)
+	{
+		return;
+	}
+
+	Realizing = true;
+	bool Open = !Descriptor.Tab->isHidden();
+	delete TabsLayout->takeAt(Index);
+	TabsLayout->insertWidget(Index, Descriptor.Tab);
+	Descriptor.Tab->setVisible(Open);
+	Descriptor.Realized = true;
+	Realizing = false;
+}
+
 
-		if (i == CurrentIndex)
+//============================================================================
+void DockAreaTabBarPrivate::parkTab(int Index)
+{
+	TabDescriptor& Descriptor = Tabs[Index];
+	if (!Descriptor.Realized)
+	{
+		return;
+	}
+
+	Realizing = true;
+	bool Open = !Descriptor.Tab->isHidden();
+	Descriptor.Width = Descriptor.Tab->sizeHint().width();
+	TabsLayout->removeWidget(Descriptor.Tab);
+	Descriptor.Tab->setParent(ParkingWidget);
+	Descriptor.Tab->setVisible(Open);
+	TabsLayout->insertSpacerItem(Index, new QSpacerItem(Open ? Descriptor.Width : 0,
+		0, QSizePolicy::Fixed, QSizePolicy::Minimum));
+	Descriptor.Realized = false;
+	Realizing = false;
+}
+
+
+//============================================================================
+void DockAreaTabBarPrivate::updateRealizedTabs()
+{
+	if (!Virtualized)
+	{
+		return;
+	}
+
+	int ViewportWidth = _this->viewport()->width();
+	int ScrollPos = _this->horizontalScrollBar()->value();
+	int Left = ScrollPos - ViewportWidth;
+	int Right = ScrollPos + 2 * ViewportWidth;
+	int x = 0;
+	for (int i = 0; i < Tabs.count(); ++i)
+	{
+		const TabDescriptor& Descriptor = Tabs[i];
+		int Width = tabWidth(Descriptor);
+		bool Visible = Width > 0 && (x + Width) >= Left && x <= Right;
+		if (Visible || i == CurrentIndex)
 		{
-			TabWidget->show();
-			TabWidget->setActiveTab(true);
-			_this->ensureWidgetVisible(TabWidget);
+			realizeTab(i);
 		}
 		else
 		{
-			TabWidget->setActiveTab(false);
+			parkTab(i);
+			// The open state of parked tabs may have changed since they have
+			// been parked, so we need to adjust the placeholder size
+			QSpacerItem* Spacer = TabsLayout->itemAt(i)->spacerItem();
+			if (Spacer && Spacer->sizeHint().width() != Width)
+			{
+				Spacer->changeSize(Width, 0, QSizePolicy::Fixed, QSizePolicy::Minimum);
+				TabsLayout->invalidate();
+			}
 		}
+		x += Width;
 	}
 }
 
-
 //============================================================================
 CDockAreaTabBar::CDockAreaTabBar(CDockAreaWidget* parent) :
 	QScrollArea(parent),
@@ -128,6 +293,19 @@ CDockAreaTabBar::CDockAreaTabBar(CDockAreaWidget* parent) :
 	d->TabsLayout->setSpacing(0);
 	d->TabsLayout->addStretch(1);
 	d->TabsContainerWidget->setLayout(d->TabsLayout);
+
+	d->Virtualized = parent->dockManager()->configFlags().testFlag(CDockManager::VirtualizedTabBar);
+	if (d->Virtualized)
+	{
+		d->ParkingWidget = new QWidget(this);
+		d->ParkingWidget->hide();
+		d->RealizeTimer = new QTimer(this);
+		d->RealizeTimer->setSingleShot(true);
+		d->RealizeTimer->setInterval(0);
+		connect(d->RealizeTimer, SIGNAL(timeout()), SLOT(updateRealizedTabs()));
+		connect(horizontalScrollBar(), SIGNAL(valueChanged(int)), d->RealizeTimer, SLOT(start()));
+		connect(horizontalScrollBar(), SIGNAL(rangeChanged(int, int)), d->RealizeTimer, SLOT(start()));
+	}
 }
 
 //============================================================================
@@ -153,6 +331,21 @@ void CDockAreaTabBar::wheelEvent(QWheelEvent* Event)
 }
 
 
+//============================================================================
+void CDockAreaTabBar::resizeEvent(QResizeEvent* Event)
+{
+	Super::resizeEvent(Event);
+	d->scheduleRealizedTabsUpdate();
+}
+
+
+//============================================================================
+void CDockAreaTabBar::updateRealizedTabs()
+{
+	d->updateRealizedTabs();
+}
+
+
 //============================================================================
 void CDockAreaTabBar::mousePressEvent(QMouseEvent* ev)
 {
@@ -171,7 +364,7 @@ void CDockAreaTabBar::mouseReleaseEvent(QMouseEvent* ev)
 {
 	if (ev->button() == Qt::LeftButton)
 	{
-		qDebug() << "CTabsScrollArea::mouseReleaseEvent";
+		ADS_PRINT("CTabsScrollArea::mouseReleaseEvent");
 		ev->accept();
 		d->FloatingWidget = nullptr;
 		d->DragStartMousePos = QPoint();
@@ -215,7 +408,7 @@ void CDockAreaTabBar::mouseMoveEvent(QMouseEvent* ev)
 	int DragDistance = (d->DragStartMousePos - ev->pos()).manhattanLength();
 	if (DragDistance >= CDockManager::startDragDistance())
 	{
-		qDebug() << "CTabsScrollArea::startFloating";
+		ADS_PRINT("CTabsScrollArea::startFloating");
 		startFloating(d->DragStartMousePos);
 		auto Overlay = d->DockArea->dockManager()->containerOverlay();
 		Overlay->setAllowedAreas(OuterDockAreas);
@@ -264,6 +457,14 @@ CFloatingDockContainer* CDockAreaTabBar::makeAreaFloating(const QPoint& Offset,
 //============================================================================
 void CDockAreaTabBar::startFloating(const QPoint& Offset)
 {
+	if (d->DockArea->dockManager()->configFlags().testFlag(CDockManager::GhostDragPreview))
+	{
+		auto Preview = new CFloatingDragPreview(d->DockArea);
+		Preview->startFloating(Offset, d->DockArea->size(), DraggingFloatingWidget, this);
+		d->FloatingWidget = Preview;
+		return;
+	}
+
 	d->FloatingWidget = makeAreaFloating(Offset, DraggingFloatingWidget);
 }
 
@@ -292,15 +493,38 @@ void CDockAreaTabBar::setCurrentIndex(int index)
 //============================================================================
 int CDockAreaTabBar::count() const
 {
-	// The tab bar contains a stretch item as last item
-	return d->TabsLayout->count() - 1;
+	return d->Tabs.count();
 }
 
 
 //===========================================================================
 void CDockAreaTabBar::insertTab(int Index, CDockWidgetTab* Tab)
 {
-	d->TabsLayout->insertWidget(Index, Tab);
+	if (Index < 0 || Index > count())
+	{
+		Index = count();
+	}
+	TabDescriptor Descriptor;
+	Descriptor.Tab = Tab;
+	if (d->Virtualized)
+	{
+		// New tabs start parked - the deferred update realizes them if they
+		// are near the visible viewport
+		d->Realizing = true;
+		bool Open = !Tab->isHidden();
+		Descriptor.Realized = false;
+		Descriptor.Width = Tab->sizeHint().width();
+		Tab->setParent(d->ParkingWidget);
+		Tab->setVisible(Open);
+		d->TabsLayout->insertSpacerItem(Index, new QSpacerItem(0, 0,
+			QSizePolicy::Fixed, QSizePolicy::Minimum));
+		d->Realizing = false;
+	}
+	else
+	{
+		d->TabsLayout->insertWidget(Index, Tab);
+	}
+	d->Tabs.insert(Index, Descriptor);
 	connect(Tab, SIGNAL(clicked()), this, SLOT(onTabClicked()));
 	connect(Tab, SIGNAL(closeRequested()), this, SLOT(onTabCloseRequested()));
 	connect(Tab, SIGNAL(closeOtherTabsRequested()), this, SLOT(onCloseOtherTabsRequested()));
@@ -311,6 +535,7 @@ void CDockAreaTabBar::insertTab(int Index, CDockWidgetTab* Tab)
 	{
 		setCurrentIndex(d->CurrentIndex + 1);
 	}
+	d->scheduleRealizedTabsUpdate();
 }
 
 
@@ -321,9 +546,13 @@ void CDockAreaTabBar::removeTab(CDockWidgetTab* Tab)
 	{
 		return;
 	}
-	qDebug() << "CDockAreaTabBar::removeTab ";
+	ADS_PRINT("CDockAreaTabBar::removeTab ");
 	int NewCurrentIndex = currentIndex();
-	int RemoveIndex = d->TabsLayout->indexOf(Tab);
+	int RemoveIndex = d->indexOf(Tab);
+	if (RemoveIndex < 0)
+	{
+		return;
+	}
 	if (count() == 1)
 	{
 		NewCurrentIndex = -1;
@@ -338,7 +567,7 @@ void CDockAreaTabBar::removeTab(CDockWidgetTab* Tab)
 		// First we walk to the right to search for the next visible tab
 		for (int i = (RemoveIndex + 1); i < count(); ++i)
 		{
-			if (tab(i)->isVisibleTo(this))
+			if (isTabOpen(i))
 			{
 				NewCurrentIndex = i - 1;
 				break;
@@ -351,7 +580,7 @@ void CDockAreaTabBar::removeTab(CDockWidgetTab* Tab)
 		{
 			for (int i = (RemoveIndex - 1); i >= 0; --i)
 			{
-				if (tab(i)->isVisibleTo(this))
+				if (isTabOpen(i))
 				{
 					NewCurrentIndex = i;
 					break;
@@ -361,10 +590,22 @@ void CDockAreaTabBar::removeTab(CDockWidgetTab* Tab)
 	}
 
 	emit removingTab(RemoveIndex);
-	d->TabsLayout->removeWidget(Tab);
+	if (d->Tabs[RemoveIndex].Realized)
+	{
+		d->TabsLayout->removeWidget(Tab);
+	}
+	else
+	{
+		delete d->TabsLayout->takeAt(RemoveIndex);
+	}
+	d->Tabs.remove(RemoveIndex);
+	if (Tab == d->ActiveTab)
+	{
+		d->ActiveTab = nullptr;
+	}
 	Tab->disconnect(this);
 	Tab->removeEventFilter(this);
-	qDebug() << "NewCurrentIndex " << NewCurrentIndex;
+	ADS_PRINT("NewCurrentIndex " << NewCurrentIndex);
 	if (NewCurrentIndex != d->CurrentIndex)
 	{
 		setCurrentIndex(NewCurrentIndex);
@@ -392,7 +633,7 @@ CDockWidgetTab* CDockAreaTabBar::currentTab() const
 	}
 	else
 	{
-		return qobject_cast<CDockWidgetTab*>(d->TabsLayout->itemAt(d->CurrentIndex)->widget());
+		return d->Tabs[d->CurrentIndex].Tab;
 	}
 }
 
@@ -406,7 +647,7 @@ void CDockAreaTabBar::onTabClicked()
 		return;
 	}
 
-	int index = d->TabsLayout->indexOf(Tab);
+	int index = d->indexOf(Tab);
 	if (index < 0)
 	{
 		return;
@@ -420,7 +661,7 @@ void CDockAreaTabBar::onTabClicked()
 void CDockAreaTabBar::onTabCloseRequested()
 {
 	CDockWidgetTab* Tab = qobject_cast<CDockWidgetTab*>(sender());
-	int Index = d->TabsLayout->indexOf(Tab);
+	int Index = d->indexOf(Tab);
 	closeTab(Index);
 }
 
@@ -447,7 +688,7 @@ CDockWidgetTab* CDockAreaTabBar::tab(int Index) const
 	{
 		return nullptr;
 	}
-	return qobject_cast<CDockWidgetTab*>(d->TabsLayout->itemAt(Index)->widget());
+	return d->Tabs[Index].Tab;
 }
 
 
@@ -460,7 +701,7 @@ void CDockAreaTabBar::onTabWidgetMoved(const QPoint& GlobalPos)
 		return;
 	}
 
-	int fromIndex = d->TabsLayout->indexOf(MovingTab);
+	int fromIndex = d->indexOf(MovingTab);
 	auto MousePos = mapFromGlobal(GlobalPos);
 	int toIndex = -1;
 	// Find tab under mouse
@@ -473,7 +714,7 @@ void CDockAreaTabBar::onTabWidgetMoved(const QPoint& GlobalPos)
 			continue;
 		}
 
-		toIndex = d->TabsLayout->indexOf(DropTab);
+		toIndex = i;
 		if (toIndex == fromIndex)
 		{
 			toIndex = -1;
@@ -487,12 +728,14 @@ void CDockAreaTabBar::onTabWidgetMoved(const QPoint& GlobalPos)
 		break;
 	}
 
-	// Now check if the mouse is behind the last tab
+	// Now check if the mouse is behind the last tab. A parked tab has no
+	// valid geometry, so we use the geometry of its layout item, that is
+	// either the tab or the spacer that replaces it
 	if (toIndex < 0)
 	{
-		if (MousePos.x() > tab(count() - 1)->geometry().right())
+		if (MousePos.x() > d->TabsLayout->itemAt(count() - 1)->geometry().right())
 		{
-			qDebug() << "after all tabs";
+			ADS_PRINT("after all tabs");
 			toIndex = count() - 1;
 		}
 		else
@@ -503,9 +746,10 @@ void CDockAreaTabBar::onTabWidgetMoved(const QPoint& GlobalPos)
 
 	d->TabsLayout->removeWidget(MovingTab);
 	d->TabsLayout->insertWidget(toIndex, MovingTab);
+	d->Tabs.move(fromIndex, toIndex);
 	if (toIndex >= 0)
 	{
-		qDebug() << "tabMoved from " << fromIndex << " to " << toIndex;
+		ADS_PRINT("tabMoved from " << fromIndex << " to " << toIndex);
 		emit tabMoved(fromIndex, toIndex);
 		setCurrentIndex(toIndex);
 	}
@@ -535,7 +779,7 @@ bool CDockAreaTabBar::eventFilter(QObject *watched, QEvent *event)
 {
 	bool Result = Super::eventFilter(watched, event);
 	CDockWidgetTab* Tab = qobject_cast<CDockWidgetTab*>(watched);
-	if (!Tab)
+	if (!Tab || d->Realizing)
 	{
 		return Result;
 	}
@@ -543,9 +787,30 @@ bool CDockAreaTabBar::eventFilter(QObject *watched, QEvent *event)
 	switch (event->type())
 	{
 	case QEvent::Hide:
-		 emit tabClosed(d->TabsLayout->indexOf(Tab)); break;
 	case QEvent::Show:
-		 emit tabOpened(d->TabsLayout->indexOf(Tab)); break;
+	case QEvent::HideToParent:
+	case QEvent::ShowToParent:
+		 break;
+
+	default:
+		 return Result;
+	}
+
+	// Parked tabs never become visible, so for these tabs we need to track
+	// the explicit show and hide requests. The index lookup is a linear
+	// search, so it is only done for the show and hide events
+	int Index = d->indexOf(Tab);
+	bool Realized = (Index < 0) || d->Tabs[Index].Realized;
+	switch (event->type())
+	{
+	case QEvent::Hide:
+		 if (Realized) {emit tabClosed(Index);} break;
+	case QEvent::Show:
+		 if (Realized) {emit tabOpened(Index);} break;
+	case QEvent::HideToParent:
+		 if (!Realized) {emit tabClosed(Index); d->scheduleRealizedTabsUpdate();} break;
+	case QEvent::ShowToParent:
+		 if (!Realized) {emit tabOpened(Index); d->scheduleRealizedTabsUpdate();} break;
 	default:
 		break;
 	}
@@ -58,9 +58,15 @@ private slots:
 	void onTabCloseRequested();
 	void onCloseOtherTabsRequested();
 	void onTabWidgetMoved(const QPoint& GlobalPos);
+	void updateRealizedTabs();
 
 protected:
 	virtual void wheelEvent(QWheelEvent* Event) override;
+
+	/**
+	 * Updates the realized tabs in virtualized mode
+	 */
+	virtual void resizeEvent(QResizeEvent* Event) override;
 	/**
 	 * Stores mouse position to detect dragging
 	 */
@@ -146,7 +152,9 @@ public:
 	/**
 	 * This function returns true if the tab is open, that means if it is
 	 * visible to the user. If the function returns false, the tab is
-	 * closed
+	 * closed.
+	 * In virtualized mode an open tab may be parked outside of the tabs
+	 * layout if it is far away from the visible viewport
 	 */
 	bool isTabOpen(int Index) const;
 
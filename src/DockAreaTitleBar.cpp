@@ -66,12 +66,26 @@ struct DockAreaTitleBarPrivate
 	CDockAreaTabBar* TabBar;
 	bool MenuOutdated = true;
 	QMenu* TabsMenu;
+	QList<QAction*> TabActions;
 
 	/**
 	 * Private data constructor
 	 */
 	DockAreaTitleBarPrivate(CDockAreaTitleBar* _public);
 
+	/**
+	 * Creates the tabs menu action for the tab with the given index and
+	 * inserts it at the same position into the tabs menu
+	 */
+	void insertTabsMenuAction(int Index);
+
+	/**
+	 * Updates text, icon, tool tip and visibility of the tabs menu action
+	 * for the tab with the given index. Properties are only assigned if
+	 * they changed
+	 */
+	void updateTabsMenuAction(int Index);
+
 	/**
 	 * Creates the title bar close and menu buttons
 	 */
@@ -126,6 +140,45 @@ DockAreaTitleBarPrivate::DockAreaTitleBarPrivate(CDockAreaTitleBar* _public) :
 }
 
 
+//============================================================================
+void DockAreaTitleBarPrivate::insertTabsMenuAction(int Index)
+{
+	QMenu* Menu = TabsMenuButton->menu();
+	QAction* Action = new QAction(Menu);
+	Menu->insertAction(TabActions.value(Index, nullptr), Action);
+	TabActions.insert(Index, Action);
+	updateTabsMenuAction(Index);
+}
+
+
+//============================================================================
+void DockAreaTitleBarPrivate::updateTabsMenuAction(int Index)
+{
+	auto Tab = TabBar->tab(Index);
+	QAction* Action = TabActions.value(Index, nullptr);
+	if (!Tab || !Action)
+	{
+		return;
+	}
+
+	if (Action->text() != Tab->text())
+	{
+		Action->setText(Tab->text());
+	}
+	if (Action->icon().cacheKey() != Tab->icon().cacheKey())
+	{
+		Action->setIcon(Tab->icon());
+	}
+	#ifndef QT_NO_TOOLTIP
+	if (Action->toolTip() != Tab->toolTip())
+	{
+		Action->setToolTip(Tab->toolTip());
+	}
+	#endif
+	Action->setVisible(TabBar->isTabOpen(Index));
+}
+
+
 //============================================================================
 void DockAreaTitleBarPrivate::createButtons()
 {
@@ -190,11 +243,11 @@ void DockAreaTitleBarPrivate::createTabBar()
 {
 	TabBar = new CDockAreaTabBar(DockArea);
 	TopLayout->addWidget(TabBar);
-	_this->connect(TabBar, SIGNAL(tabClosed(int)), SLOT(markTabsMenuOutdated()));
-	_this->connect(TabBar, SIGNAL(tabOpened(int)), SLOT(markTabsMenuOutdated()));
-	_this->connect(TabBar, SIGNAL(tabInserted(int)), SLOT(markTabsMenuOutdated()));
-	_this->connect(TabBar, SIGNAL(removingTab(int)), SLOT(markTabsMenuOutdated()));
-	_this->connect(TabBar, SIGNAL(tabMoved(int, int)), SLOT(markTabsMenuOutdated()));
+	_this->connect(TabBar, SIGNAL(tabClosed(int)), SLOT(onTabOpenedOrClosed(int)));
+	_this->connect(TabBar, SIGNAL(tabOpened(int)), SLOT(onTabOpenedOrClosed(int)));
+	_this->connect(TabBar, SIGNAL(tabInserted(int)), SLOT(onTabInserted(int)));
+	_this->connect(TabBar, SIGNAL(removingTab(int)), SLOT(onRemovingTab(int)));
+	_this->connect(TabBar, SIGNAL(tabMoved(int, int)), SLOT(onTabMoved(int, int)));
 	_this->connect(TabBar, SIGNAL(currentChanged(int)), SLOT(onCurrentTabChanged(int)));
 	_this->connect(TabBar, SIGNAL(tabBarClicked(int)), SIGNAL(tabBarClicked(int)));
 
@@ -248,35 +301,78 @@ void CDockAreaTitleBar::markTabsMenuOutdated()
 //============================================================================
 void CDockAreaTitleBar::onTabsMenuAboutToShow()
 {
-	if (!d->MenuOutdated)
+	if (d->MenuOutdated)
 	{
+		d->TabsMenuButton->menu()->clear();
+		d->TabActions.clear();
+		for (int i = 0; i < d->TabBar->count(); ++i)
+		{
+			d->insertTabsMenuAction(i);
+		}
+		d->MenuOutdated = false;
 		return;
 	}
 
-	QMenu* menu = d->TabsMenuButton->menu();
-	menu->clear();
-	for (int i = 0; i < d->TabBar->count(); ++i)
+	// Tab titles, icons and tool tips may have changed since the menu has
+	// been shown the last time. The existing actions are reused and only
+	// changed properties are assigned
+	for (int i = 0; i < d->TabActions.count(); ++i)
 	{
-		if (!d->TabBar->isTabOpen(i))
-		{
-			continue;
-		}
-		auto Tab = d->TabBar->tab(i);
-		QAction* Action = menu->addAction(Tab->icon(), Tab->text());
-		#ifndef QT_NO_TOOLTIP
-		Action->setToolTip(Tab->toolTip());
-		#endif
-		Action->setData(i);
+		d->updateTabsMenuAction(i);
 	}
+}
+
+
+//============================================================================
+void CDockAreaTitleBar::onTabInserted(int Index)
+{
+	if (!d->MenuOutdated)
+	{
+		d->insertTabsMenuAction(Index);
+	}
+}
 
-	d->MenuOutdated = false;
+
+//============================================================================
+void CDockAreaTitleBar::onRemovingTab(int Index)
+{
+	if (!d->MenuOutdated && Index >= 0 && Index < d->TabActions.count())
+	{
+		delete d->TabActions.takeAt(Index);
+	}
+}
+
+
+//============================================================================
+void CDockAreaTitleBar::onTabMoved(int From, int To)
+{
+	if (d->MenuOutdated || From < 0 || From >= d->TabActions.count())
+	{
+		return;
+	}
+
+	QMenu* Menu = d->TabsMenuButton->menu();
+	QAction* Action = d->TabActions.takeAt(From);
+	Menu->removeAction(Action);
+	Menu->insertAction(d->TabActions.value(To, nullptr), Action);
+	d->TabActions.insert(To, Action);
+}
+
+
+//============================================================================
+void CDockAreaTitleBar::onTabOpenedOrClosed(int Index)
+{
+	if (!d->MenuOutdated)
+	{
+		d->updateTabsMenuAction(Index);
+	}
 }
 
 
 //============================================================================
 void CDockAreaTitleBar::onCloseButtonClicked()
 {
-	qDebug() << "CDockAreaTitleBar::onCloseButtonClicked";
+	ADS_PRINT("CDockAreaTitleBar::onCloseButtonClicked");
 	if (d->testConfigFlag(CDockManager::DockAreaCloseButtonClosesTab))
 	{
 		d->TabBar->closeTab(d->TabBar->currentIndex());
@@ -301,7 +397,11 @@ void CDockAreaTitleBar::onUndockButtonClicked()
 //============================================================================
 void CDockAreaTitleBar::onTabsMenuActionTriggered(QAction* Action)
 {
-	int Index = Action->data().toInt();
+	int Index = d->TabActions.indexOf(Action);
+	if (Index < 0)
+	{
+		return;
+	}
 	d->TabBar->setCurrentIndex(Index);
 	emit tabBarClicked(Index);
 }
@@ -341,7 +441,6 @@ QAbstractButton* CDockAreaTitleBar::button(TitleBarButton which) const
 void CDockAreaTitleBar::setVisible(bool Visible)
 {
 	Super::setVisible(Visible);
-	markTabsMenuOutdated();
 }
 
 
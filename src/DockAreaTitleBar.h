@@ -58,9 +58,18 @@ private slots:
 	void onUndockButtonClicked();
 	void onTabsMenuActionTriggered(QAction* Action);
 	void onCurrentTabChanged(int Index);
+	void onTabInserted(int Index);
+	void onRemovingTab(int Index);
+	void onTabMoved(int From, int To);
+	void onTabOpenedOrClosed(int Index);
 	void showContextMenu(const QPoint& pos);
 
 public slots:
+	/**
+	 * Forces a complete rebuild of the tabs menu the next time it is shown.
+	 * Normally the menu actions are updated incrementally when tabs are
+	 * inserted, removed, moved, opened or closed.
+	 */
 	void markTabsMenuOutdated();
 
 
@@ -41,8 +41,10 @@
 #include <QMenu>
 #include <QSplitter>
 #include <QXmlStreamWriter>
+#include <QDataStream>
 #include <QVector>
 #include <QList>
+#include <QPointer>
 
 
 #include "DockContainerWidget.h"
@@ -53,6 +55,7 @@
 #include "DockAreaTabBar.h"
 #include "DockSplitter.h"
 #include "DockAreaTitleBar.h"
+#include "DockInstrumentation.h"
 
 #include <iostream>
 
@@ -64,7 +67,11 @@ static const char* const ACTION_PROPERTY = "action";
 
 /**
  * New dock area layout mimics stack layout but only inserts the current
- * widget into the internal QLayout object
+ * widget into the internal QLayout object.
+ * If KeepParented is true, all widgets are children of the parent widget
+ * of the layout. Switching the current widget then only changes the layout
+ * item and the visibility of the widgets and does not reparent them. This
+ * prevents the recreation of native window handles of the content widgets.
  */
 class CDockAreaLayout
 {
@@ -73,13 +80,36 @@ private:
 	QList<QWidget*> m_Widgets;
 	int m_CurrentIndex = -1;
 	QWidget* m_CurrentWidget = nullptr;
+	bool m_KeepParented = false;
+
+	/**
+	 * Removes the current widget from the parent layout. The widget is
+	 * unparented, if the widgets are not kept parented or if Unparent is
+	 * true
+	 */
+	void takeCurrentWidget(bool Unparent)
+	{
+		auto LayoutItem = m_ParentLayout->takeAt(1);
+		if (!LayoutItem)
+		{
+			return;
+		}
+
+		if (Unparent || !m_KeepParented)
+		{
+			LayoutItem->widget()->setParent(nullptr);
+			ADS_INSTRUMENT_COUNT(ReparentOperations);
+		}
+		delete LayoutItem;
+	}
 
 public:
 	/**
 	 * Creates an instance with the given parent layout
 	 */
-	CDockAreaLayout(QBoxLayout* ParentLayout)
-		: m_ParentLayout(ParentLayout)
+	CDockAreaLayout(QBoxLayout* ParentLayout, bool KeepParented = false)
+		: m_ParentLayout(ParentLayout),
+		  m_KeepParented(KeepParented)
 	{
 
 	}
@@ -98,7 +128,24 @@ public:
 	 */
 	void insertWidget(int index, QWidget* Widget)
 	{
-		Widget->setParent(nullptr);
+		if (m_KeepParented)
+		{
+			QWidget* Parent = m_ParentLayout->parentWidget();
+			if (Widget->parentWidget() != Parent)
+			{
+				Widget->setParent(Parent);
+				ADS_INSTRUMENT_COUNT(ReparentOperations);
+			}
+			Widget->hide();
+		}
+		else
+		{
+			if (Widget->parentWidget())
+			{
+				ADS_INSTRUMENT_COUNT(ReparentOperations);
+			}
+			Widget->setParent(nullptr);
+		}
 		if (index < 0)
 		{
 			index = m_Widgets.count();
@@ -124,14 +171,15 @@ public:
 	{
 		if (currentWidget() == Widget)
 		{
-			auto LayoutItem = m_ParentLayout->takeAt(1);
-			if (LayoutItem)
-			{
-				LayoutItem->widget()->setParent(nullptr);
-			}
+			takeCurrentWidget(true);
 			m_CurrentWidget = nullptr;
 			m_CurrentIndex = -1;
 		}
+		else if (m_KeepParented)
+		{
+			Widget->setParent(nullptr);
+			ADS_INSTRUMENT_COUNT(ReparentOperations);
+		}
 		m_Widgets.removeOne(Widget);
 	}
 
@@ -164,12 +212,11 @@ public:
 			parent->setUpdatesEnabled(false);
 		}
 
-		auto LayoutItem = m_ParentLayout->takeAt(1);
-		if (LayoutItem)
+		takeCurrentWidget(false);
+		if (next->parentWidget() != parent)
 		{
-			LayoutItem->widget()->setParent(nullptr);
+			ADS_INSTRUMENT_COUNT(ReparentOperations);
 		}
-
 		m_ParentLayout->addWidget(next);
 		if (prev)
 		{
@@ -350,13 +397,15 @@ CDockAreaWidget::CDockAreaWidget(CDockManager* DockManager, CDockContainerWidget
 	setLayout(d->Layout);
 
 	d->createTitleBar();
-	d->ContentsLayout = new DockAreaLayout(d->Layout);
+	d->ContentsLayout = new DockAreaLayout(d->Layout,
+		DockManager->configFlags().testFlag(CDockManager::KeepTabContentParented));
+	ADS_INSTRUMENT_COUNT(WidgetsCreated);
 }
 
 //============================================================================
 CDockAreaWidget::~CDockAreaWidget()
 {
-	qDebug() << "~CDockAreaWidget()";
+	ADS_PRINT("~CDockAreaWidget()");
 	delete d->ContentsLayout;
 	delete d;
 }
@@ -402,6 +451,10 @@ void CDockAreaWidget::insertDockWidget(int index, CDockWidget* DockWidget,
 		setCurrentIndex(index);
 	}
 	DockWidget->setDockArea(this);
+	if (auto Container = dockContainer())
+	{
+		Container->invalidateTopLevelDockWidget();
+	}
 	d->updateTitleBarButtonStates();
 }
 
@@ -409,7 +462,7 @@ void CDockAreaWidget::insertDockWidget(int index, CDockWidget* DockWidget,
 //============================================================================
 void CDockAreaWidget::removeDockWidget(CDockWidget* DockWidget)
 {
-	qDebug() << "CDockAreaWidget::removeDockWidget";
+	ADS_PRINT("CDockAreaWidget::removeDockWidget");
 	auto NextOpenDockWidget = nextOpenDockWidget(DockWidget);
 
 	d->ContentsLayout->removeWidget(DockWidget);
@@ -417,13 +470,17 @@ void CDockAreaWidget::removeDockWidget(CDockWidget* DockWidget)
 	TabWidget->hide();
 	d->tabBar()->removeTab(TabWidget);
 	CDockContainerWidget* DockContainer = dockContainer();
+	if (DockContainer)
+	{
+		DockContainer->invalidateTopLevelDockWidget();
+	}
 	if (NextOpenDockWidget)
 	{
 		setCurrentDockWidget(NextOpenDockWidget);
 	}
 	else if (d->ContentsLayout->isEmpty() && DockContainer->dockAreaCount() > 1)
 	{
-		qDebug() << "Dock Area empty";
+		ADS_PRINT("Dock Area empty");
 		DockContainer->removeDockArea(this);
 		this->deleteLater();
 	}
@@ -483,7 +540,7 @@ void CDockAreaWidget::hideAreaWithNoVisibleContent()
 //============================================================================
 void CDockAreaWidget::onTabCloseRequested(int Index)
 {
-	qDebug() << "CDockAreaWidget::onTabCloseRequested " << Index;
+	ADS_PRINT("CDockAreaWidget::onTabCloseRequested " << Index);
 	dockWidget(Index)->toggleView(false);
 }
 
@@ -529,6 +586,7 @@ void CDockAreaWidget::internalSetCurrentDockWidget(CDockWidget* DockWidget)
 //============================================================================
 void CDockAreaWidget::setCurrentIndex(int index)
 {
+	ADS_INSTRUMENT_SCOPE(TabSwitch);
 	auto TabBar = d->tabBar();
 	if (index < 0 || index > (TabBar->count() - 1))
 	{
@@ -539,6 +597,9 @@ void CDockAreaWidget::setCurrentIndex(int index)
     emit currentChanging(index);
     TabBar->setCurrentIndex(index);
 	d->ContentsLayout->setCurrentIndex(index);
+	// The content of a factory created dock widget is created in its show
+	// event, so activating a tab of a hidden dock manager or inside of a
+	// batch update does not create the content yet
 	d->ContentsLayout->currentWidget()->show();
 	emit currentChanged(index);
 }
@@ -646,11 +707,11 @@ CDockWidget* CDockAreaWidget::dockWidget(int Index) const
 //============================================================================
 void CDockAreaWidget::reorderDockWidget(int fromIndex, int toIndex)
 {
-	qDebug() << "CDockAreaWidget::reorderDockWidget";
+	ADS_PRINT("CDockAreaWidget::reorderDockWidget");
 	if (fromIndex >= d->ContentsLayout->count() || fromIndex < 0
      || toIndex >= d->ContentsLayout->count() || toIndex < 0 || fromIndex == toIndex)
 	{
-		qDebug() << "Invalid index for tab movement" << fromIndex << toIndex;
+		ADS_PRINT("Invalid index for tab movement" << fromIndex << toIndex);
 		return;
 	}
 
@@ -666,6 +727,10 @@ void CDockAreaWidget::toggleDockWidgetView(CDockWidget* DockWidget, bool Open)
 {
 	Q_UNUSED(DockWidget);
 	Q_UNUSED(Open);
+	if (auto Container = dockContainer())
+	{
+		Container->invalidateTopLevelDockWidget();
+	}
 	updateTitleBarVisibility();
 }
 
@@ -679,6 +744,14 @@ void CDockAreaWidget::updateTitleBarVisibility()
 		return;
 	}
 
+	// The dock manager updates the title bars of all dock areas at the end
+	// of a batch update
+	if (d->DockManager && d->DockManager->isUpdating())
+	{
+		Container->markTitleBarVisibilityOutdated();
+		return;
+	}
+
 	if (d->TitleBar)
 	{
 		d->TitleBar->setVisible(!Container->isFloating() || !Container->hasTopLevelDockWidget());
@@ -705,8 +778,8 @@ void CDockAreaWidget::saveState(QXmlStreamWriter& s) const
 	auto CurrentDockWidget = currentDockWidget();
 	QString Name = CurrentDockWidget ? CurrentDockWidget->objectName() : "";
 	s.writeAttribute("Current", Name);
-	qDebug() << "CDockAreaWidget::saveState TabCount: " << d->ContentsLayout->count()
-			<< " Current: " << Name;
+	ADS_PRINT("CDockAreaWidget::saveState TabCount: " << d->ContentsLayout->count()
+			<< " Current: " << Name);
 	for (int i = 0; i < d->ContentsLayout->count(); ++i)
 	{
 		dockWidget(i)->saveState(s);
@@ -715,6 +788,20 @@ void CDockAreaWidget::saveState(QXmlStreamWriter& s) const
 }
 
 
+//============================================================================
+void CDockAreaWidget::saveState(QDataStream& s) const
+{
+	auto CurrentDockWidget = currentDockWidget();
+	QString Name = CurrentDockWidget ? CurrentDockWidget->objectName() : "";
+	s << quint8(internal::StateAreaNode) << qint32(d->ContentsLayout->count())
+	  << Name;
+	for (int i = 0; i < d->ContentsLayout->count(); ++i)
+	{
+		dockWidget(i)->saveState(s);
+	}
+}
+
+
 //============================================================================
 CDockWidget* CDockAreaWidget::nextOpenDockWidget(CDockWidget* DockWidget) const
 {
@@ -767,6 +854,12 @@ void CDockAreaWidget::toggleView(bool Open)
 void CDockAreaWidget::setVisible(bool Visible)
 {
 	Super::setVisible(Visible);
+	CDockContainerWidget* Container = dockContainer();
+	if (Container)
+	{
+		Container->onDockAreaVisibilityChanged(this);
+	}
+
 	if (d->UpdateTitleBarButtons)
 	{
 		d->updateTitleBarButtonStates();
@@ -784,10 +877,23 @@ QAbstractButton* CDockAreaWidget::titleBarButton(TitleBarButton which) const
 //============================================================================
 void CDockAreaWidget::closeArea()
 {
+	// Closing the last dock widget may delete this area, so we keep the
+	// container that compacts its splitter tree at the end
+	QPointer<CDockContainerWidget> Container = dockContainer();
+	if (Container)
+	{
+		Container->beginCompactionBatch();
+	}
+
 	for (auto DockWidget : openedDockWidgets())
 	{
 		DockWidget->toggleView(false);
 	}
+
+	if (Container)
+	{
+		Container->endCompactionBatch();
+	}
 }
 
 
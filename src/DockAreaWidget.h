@@ -36,6 +36,7 @@
 #include "DockWidget.h"
 
 class QXmlStreamWriter;
+class QDataStream;
 class QAbstractButton;
 
 namespace ads
@@ -232,6 +233,11 @@ public:
 	 */
 	void saveState(QXmlStreamWriter& Stream) const;
 
+	/**
+	 * Saves the state into the given binary stream
+	 */
+	void saveState(QDataStream& Stream) const;
+
 	/**
 	 * This functions returns the dock widget features of all dock widget in
 	 * this area.
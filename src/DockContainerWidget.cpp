@@ -32,11 +32,15 @@
 
 #include <QEvent>
 #include <QList>
+#include <QHash>
+#include <QVector>
+#include <QPair>
 #include <QGridLayout>
 #include <QPointer>
 #include <QVariant>
 #include <QDebug>
 #include <QXmlStreamWriter>
+#include <QDataStream>
 #include <QAbstractButton>
 
 #include "DockManager.h"
@@ -46,9 +50,10 @@
 #include "DockOverlay.h"
 #include "ads_globals.h"
 #include "DockSplitter.h"
+#include "DockLayoutState.h"
 
 #include <functional>
-#include <iostream>
+#include <algorithm>
 
 #if QT_VERSION < 0x050900
 
@@ -128,8 +133,22 @@ public:
 	QSplitter* RootSplitter = nullptr;
 	bool isFloating = false;
 	CDockAreaWidget* LastAddedAreaCache[5];
-	int VisibleDockAreaCount = -1;
+	QHash<CDockAreaWidget*, bool> DockAreaVisibility;
+	int VisibleDockAreaCount = 0;
 	CDockAreaWidget* TopLevelDockArea = nullptr;
+	mutable bool TopLevelCacheValid = false;
+	mutable CDockAreaWidget* CachedTopLevelDockArea = nullptr;
+	mutable CDockWidget* CachedTopLevelDockWidget = nullptr;
+	QPointer<CDockWidget> LastTopLevelDockWidget;
+	QList<CDockAreaWidget*> ReusableDockAreas;
+	bool DockAreasAddedPending = false;
+	bool DockAreasRemovedPending = false;
+	bool SplitterCompactionPending = false;
+	int CompactionBatchDepth = 0;
+	bool TitleBarUpdatePending = false;
+	QVector<int> HitGridEdges;
+	QVector<QVector<QPair<QRect, CDockAreaWidget*>>> HitGridColumns;
+	bool HitGridDirty = true;
 
 	/**
 	 * Private data constructor
@@ -187,29 +206,78 @@ public:
 	void saveChildNodesState(QXmlStreamWriter& Stream, QWidget* Widget);
 
 	/**
-	 * Restore state of child nodes.
-	 * \param[in] Stream The data stream that contains the serialized state
-	 * \param[out] CreatedWidget The widget created from parsed data or 0 if
-	 * the parsed widget was an empty splitter
-	 * \param[in] Testing If Testing is true, only the stream data is
-	 * parsed without modifiying anything.
+	 * Save state of child nodes into the given binary stream
 	 */
-	bool restoreChildNodes(QXmlStreamReader& Stream, QWidget*& CreatedWidget,
-		bool Testing);
+	void saveChildNodesState(QDataStream& Stream, QWidget* Widget);
 
 	/**
-	 * Restores a splitter.
-	 * \see restoreChildNodes() for details
+	 * Creates the widget for the node with the given index of the decoded
+	 * state tree.
+	 * Returns 0 if the node is empty or if it does not contain any dock
+	 * widget that is known to the dock manager
 	 */
-	bool restoreSplitter(QXmlStreamReader& Stream, QWidget*& CreatedWidget,
-		bool Testing);
+	QWidget* restoreNode(const internal::DockingState& State, int NodeIndex);
 
 	/**
-	 * Restores a dock area.
-	 * \see restoreChildNodes() for details
+	 * Creates a splitter with all child nodes of the given splitter node.
+	 * \see restoreNode() for details
 	 */
-	bool restoreDockArea(QXmlStreamReader& Stream, QWidget*& CreatedWidget,
-		bool Testing);
+	QSplitter* restoreSplitter(const internal::DockingState& State,
+		const internal::LayoutNode& Node);
+
+	/**
+	 * Creates a dock area for the given dock area node.
+	 * \see restoreNode() for details
+	 */
+	CDockAreaWidget* restoreDockArea(const internal::LayoutNode& Node);
+
+	/**
+	 * Applies the closed state of the given dock widget state to the
+	 * given dock widget
+	 */
+	void restoreDockWidgetState(CDockWidget* DockWidget, bool Closed);
+
+	/**
+	 * Returns the dock widgets of the given dock area node that are
+	 * known to the dock manager
+	 */
+	QList<CDockWidget*> nodeDockWidgets(const internal::LayoutNode& Node) const;
+
+	/**
+	 * Returns true, if the node with the given index does not create any
+	 * widget in restoreNode()
+	 */
+	bool isEmptyNode(const internal::DockingState& State, int NodeIndex) const;
+
+	/**
+	 * Returns true, if the given existing widget has exactly the structure
+	 * that restoreNode() would create for the node with the given index.
+	 * That means, all splitters have the same orientation and all dock
+	 * areas contain the same dock widgets in the same order
+	 */
+	bool matchesNode(const internal::DockingState& State, int NodeIndex,
+		QWidget* Widget) const;
+
+	/**
+	 * Applies the splitter sizes and dock widget states of the node with
+	 * the given index to the given existing widget. The widget needs to
+	 * match the node.
+	 * \see matchesNode()
+	 */
+	void updateNode(const internal::DockingState& State, int NodeIndex,
+		QWidget* Widget);
+
+	/**
+	 * Applies the dock widget states of the given dock area node to the
+	 * given existing dock area
+	 */
+	void updateNode(const internal::LayoutNode& Node, CDockAreaWidget* DockArea);
+
+	/**
+	 * Removes and returns the reusable dock area that contains exactly
+	 * the given dock widgets or returns 0 if there is no such area
+	 */
+	CDockAreaWidget* takeReusableDockArea(const QList<CDockWidget*>& DockWidgets);
 
 	/**
 	 * Helper function for recursive dumping of layout
@@ -217,32 +285,84 @@ public:
 	void dumpRecursive(int level, QWidget* widget);
 
 	/**
-	 * Initializes the visible dock area count variable if it is not initialized
-	 * yet
+	 * Updates the cached visible dock area count if the visibility of the
+	 * given dock area changed since the last update. Dock areas that are not
+	 * in the internal list of dock areas are ignored.
 	 */
-	void initVisibleDockAreaCount()
+	void updateDockAreaVisibility(CDockAreaWidget* DockArea)
 	{
-		if (VisibleDockAreaCount > -1)
+		auto it = DockAreaVisibility.find(DockArea);
+		if (it == DockAreaVisibility.end())
 		{
 			return;
 		}
 
-		VisibleDockAreaCount = 0;
-		for (auto DockArea : DockAreas)
+		bool Visible = !DockArea->isHidden();
+		if (it.value() == Visible)
 		{
-			VisibleDockAreaCount += DockArea->isHidden() ? 0 : 1;
+			return;
 		}
+
+		it.value() = Visible;
+		VisibleDockAreaCount += Visible ? 1 : -1;
+		invalidateHitGrid();
+		invalidateTopLevelCache();
+	}
+
+	/**
+	 * Marks the cached top level dock area and dock widget as outdated.
+	 * This is required if the visibility or the membership of dock areas
+	 * changes or if dock widgets are opened, closed, added or removed
+	 */
+	void invalidateTopLevelCache()
+	{
+		TopLevelCacheValid = false;
 	}
 
 	/**
-	 * Access function for the visible dock area counter
+	 * Recomputes the cached top level dock area and dock widget if the
+	 * cache is outdated
+	 */
+	void updateTopLevelCache() const;
+
+	/**
+	 * Marks the dock area hit test grid as outdated. The grid is rebuilt on
+	 * the next call of dockAreaAt()
 	 */
-	int& visibleDockAreaCount()
+	void invalidateHitGrid()
 	{
-		// Lazy initialisation - we initialize the VisibleDockAreaCount variable
-		// on first use
-		initVisibleDockAreaCount();
-		return VisibleDockAreaCount;
+		HitGridDirty = true;
+	}
+
+	/**
+	 * Rebuilds the hit test grid from the geometries of all visible dock areas.
+	 * The dock areas of a container tile its area without overlapping. The
+	 * left and right edges of all dock areas split the container into columns
+	 * and each column contains the dock areas that cover it, sorted from
+	 * top to bottom. All rectangles are in container coordinates.
+	 */
+	void rebuildHitGrid();
+
+	/**
+	 * Returns the dock area at the given position in container coordinates
+	 * or a nullptr, if there is no visible dock area at this position.
+	 * This is a binary search for the column and a binary search for the
+	 * dock area in this column.
+	 */
+	CDockAreaWidget* hitTest(const QPoint& Pos);
+
+	/**
+	 * Counts the visible dock areas by scanning all dock areas.
+	 * This is only used for checking the cached visible dock area count
+	 */
+	int scanVisibleDockAreaCount() const
+	{
+		int Result = 0;
+		for (auto DockArea : DockAreas)
+		{
+			Result += DockArea->isHidden() ? 0 : 1;
+		}
+		return Result;
 	}
 
 	/**
@@ -251,25 +371,72 @@ public:
 	 */
 	void onVisibleDockAreaCountChanged();
 
+	/**
+	 * Returns true, if the dock manager is in a batch update and signals
+	 * and title bar updates should be deferred until the update ends
+	 */
+	bool isUpdateDeferred() const
+	{
+		return DockManager && DockManager->isUpdating();
+	}
+
+	/**
+	 * Recursively removes empty child splitters of the given splitter and
+	 * replaces child splitters with only one content widget by their
+	 * content widget
+	 */
+	void compactSplitter(QSplitter* Splitter);
+
+	/**
+	 * Compacts the complete splitter tree. This is done once at the end of
+	 * a batch update instead of on each dock area removal.
+	 */
+	void compactSplitterTree();
+
 	void emitDockAreasRemoved()
 	{
+		if (isUpdateDeferred())
+		{
+			DockAreasRemovedPending = true;
+			return;
+		}
 		onVisibleDockAreaCountChanged();
 		emit _this->dockAreasRemoved();
 	}
 
 	void emitDockAreasAdded()
 	{
+		if (isUpdateDeferred())
+		{
+			DockAreasAddedPending = true;
+			return;
+		}
 		onVisibleDockAreaCountChanged();
 		emit _this->dockAreasAdded();
 	}
 
+	/**
+	 * Installs the event filter of this container on all dock splitters of
+	 * the given widget. This is required for splitters that are moved into
+	 * this container from a floating widget
+	 */
+	void watchSplitters(QWidget* Widget)
+	{
+		for (auto Splitter : Widget->findChildren<CDockSplitter*>())
+		{
+			Splitter->installEventFilter(_this);
+		}
+	}
+
 	/**
 	 * Helper function for creation of new splitter
 	 */
 	CDockSplitter* newSplitter(Qt::Orientation orientation, QWidget* parent = nullptr)
 	{
 		CDockSplitter* s = new CDockSplitter(orientation, parent);
+		s->installEventFilter(_this);
 		s->setOpaqueResize(DockManager->configFlags().testFlag(CDockManager::OpaqueSplitterResize));
+		s->setAdaptiveOpaqueResize(DockManager->configFlags().testFlag(CDockManager::AdaptiveSplitterResize));
 		s->setChildrenCollapsible(false);
 		return s;
 	}
@@ -279,7 +446,7 @@ public:
 	void onDockAreaViewToggled(bool Visible)
 	{
 		CDockAreaWidget* DockArea = qobject_cast<CDockAreaWidget*>(_this->sender());
-		VisibleDockAreaCount += Visible ? 1 : -1;
+		updateDockAreaVisibility(DockArea);
 		onVisibleDockAreaCountChanged();
 		emit _this->dockAreaViewToggled(DockArea, Visible);
 	}
@@ -294,9 +461,53 @@ DockContainerWidgetPrivate::DockContainerWidgetPrivate(CDockContainerWidget* _pu
 }
 
 
+//============================================================================
+void DockContainerWidgetPrivate::updateTopLevelCache() const
+{
+	if (TopLevelCacheValid)
+	{
+		return;
+	}
+
+	TopLevelCacheValid = true;
+	CachedTopLevelDockArea = nullptr;
+	CachedTopLevelDockWidget = nullptr;
+	if (!isFloating)
+	{
+		return;
+	}
+
+	auto DockAreas = _this->openedDockAreas();
+	if (DockAreas.count() != 1)
+	{
+		return;
+	}
+
+	CachedTopLevelDockArea = DockAreas[0];
+	auto DockWidgets = CachedTopLevelDockArea->openedDockWidgets();
+	if (DockWidgets.count() == 1)
+	{
+		CachedTopLevelDockWidget = DockWidgets[0];
+	}
+}
+
+
 //============================================================================
 void DockContainerWidgetPrivate::onVisibleDockAreaCountChanged()
 {
+	// If the top level dock widget changed, the previous top level dock
+	// widget is not floating anymore and the new one is floating now
+	CDockWidget* TopLevelDockWidget = _this->topLevelDockWidget();
+	if (TopLevelDockWidget != LastTopLevelDockWidget)
+	{
+		if (LastTopLevelDockWidget && LastTopLevelDockWidget->dockAreaWidget())
+		{
+			CDockWidget::emitTopLevelEventForWidget(LastTopLevelDockWidget, false);
+		}
+		CDockWidget::emitTopLevelEventForWidget(TopLevelDockWidget, true);
+		LastTopLevelDockWidget = TopLevelDockWidget;
+	}
+
 	auto TopLevelDockArea = _this->topLevelDockArea();
 
 	if (TopLevelDockArea)
@@ -340,6 +551,7 @@ void DockContainerWidgetPrivate::dropIntoContainer(CFloatingDockContainer* Float
 	}
 
 	// Now we can insert the floating widget content into this container
+	watchSplitters(FloatingDockContainer);
 	auto FloatingSplitter = FloatingDockContainer->rootSplitter();
 	if (FloatingSplitter->count() == 1)
 	{
@@ -370,7 +582,9 @@ void DockContainerWidgetPrivate::dropIntoContainer(CFloatingDockContainer* Float
 	{
 		Splitter->show();
 	}
+#if (ADS_DEBUG_LEVEL > 0)
 	_this->dumpLayout();
+#endif
 }
 
 
@@ -435,6 +649,7 @@ void DockContainerWidgetPrivate::dropIntoSection(CFloatingDockContainer* Floatin
 		TargetAreaSplitter = Splitter;
 	}
 	int AreaIndex = TargetAreaSplitter->indexOf(TargetArea);
+	watchSplitters(FloatingWidget->dockContainer());
 	auto Widget = FloatingWidget->dockContainer()->findChild<QWidget*>(QString(), Qt::FindDirectChildrenOnly);
 	auto FloatingSplitter = qobject_cast<QSplitter*>(Widget);
 
@@ -499,7 +714,158 @@ void DockContainerWidgetPrivate::dropIntoSection(CFloatingDockContainer* Floatin
 
 	FloatingWidget->deleteLater();
 	addDockAreasToList(NewDockAreas);
+#if (ADS_DEBUG_LEVEL > 0)
 	_this->dumpLayout();
+#endif
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::compactSplitter(QSplitter* Splitter)
+{
+	for (int i = Splitter->count() - 1; i >= 0; --i)
+	{
+		QSplitter* ChildSplitter = qobject_cast<QSplitter*>(Splitter->widget(i));
+		if (!ChildSplitter)
+		{
+			continue;
+		}
+
+		compactSplitter(ChildSplitter);
+		if (ChildSplitter->count() > 1)
+		{
+			continue;
+		}
+
+		auto Sizes = Splitter->sizes();
+		if (ChildSplitter->count() == 1)
+		{
+			QWidget* Widget = ChildSplitter->widget(0);
+			Widget->setParent(_this);
+			internal::replaceSplitterWidget(Splitter, ChildSplitter, Widget);
+		}
+		else
+		{
+			Sizes.removeAt(i);
+		}
+		delete ChildSplitter;
+		Splitter->setSizes(Sizes);
+	}
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::compactSplitterTree()
+{
+	SplitterCompactionPending = false;
+	compactSplitter(RootSplitter);
+	if (!RootSplitter->count())
+	{
+		RootSplitter->hide();
+		return;
+	}
+
+	// We replace a superfluous root splitter with its one and only child
+	// splitter
+	QSplitter* ChildSplitter = (RootSplitter->count() == 1)
+		? qobject_cast<QSplitter*>(RootSplitter->widget(0)) : nullptr;
+	if (ChildSplitter)
+	{
+		QSplitter* OldRootSplitter = RootSplitter;
+		ChildSplitter->setParent(nullptr);
+		QLayoutItem* li = Layout->replaceWidget(OldRootSplitter, ChildSplitter);
+		RootSplitter = ChildSplitter;
+		delete li;
+		delete OldRootSplitter;
+	}
+#if (ADS_DEBUG_LEVEL > 0)
+	_this->dumpLayout();
+#endif
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::rebuildHitGrid()
+{
+	HitGridEdges.clear();
+	HitGridColumns.clear();
+	HitGridDirty = false;
+
+	QVector<QPair<QRect, CDockAreaWidget*>> Areas;
+	for (auto DockArea : DockAreas)
+	{
+		if (!DockArea->isVisible())
+		{
+			continue;
+		}
+
+		QRect Rect(DockArea->mapTo(_this, QPoint(0, 0)), DockArea->size());
+		Areas.append(qMakePair(Rect, DockArea));
+		HitGridEdges.append(Rect.left());
+		HitGridEdges.append(Rect.right() + 1);
+	}
+
+	std::sort(HitGridEdges.begin(), HitGridEdges.end());
+	HitGridEdges.erase(std::unique(HitGridEdges.begin(), HitGridEdges.end()),
+		HitGridEdges.end());
+	if (HitGridEdges.count() < 2)
+	{
+		return;
+	}
+
+	// Column i covers the range from HitGridEdges[i] to HitGridEdges[i + 1]
+	HitGridColumns.resize(HitGridEdges.count() - 1);
+	for (const auto& Area : Areas)
+	{
+		auto First = std::lower_bound(HitGridEdges.begin(), HitGridEdges.end(),
+			Area.first.left());
+		auto Last = std::lower_bound(First, HitGridEdges.end(),
+			Area.first.right() + 1);
+		for (auto it = First; it != Last; ++it)
+		{
+			HitGridColumns[it - HitGridEdges.begin()].append(Area);
+		}
+	}
+
+	for (auto& Column : HitGridColumns)
+	{
+		std::sort(Column.begin(), Column.end(),
+			[](const QPair<QRect, CDockAreaWidget*>& a, const QPair<QRect, CDockAreaWidget*>& b)
+			{
+				return a.first.top() < b.first.top();
+			});
+	}
+}
+
+
+//============================================================================
+CDockAreaWidget* DockContainerWidgetPrivate::hitTest(const QPoint& Pos)
+{
+	if (HitGridDirty)
+	{
+		rebuildHitGrid();
+	}
+
+	auto Edge = std::upper_bound(HitGridEdges.begin(), HitGridEdges.end(), Pos.x());
+	int ColumnIndex = (Edge - HitGridEdges.begin()) - 1;
+	if (ColumnIndex < 0 || ColumnIndex >= HitGridColumns.count())
+	{
+		return nullptr;
+	}
+
+	const auto& Column = HitGridColumns.at(ColumnIndex);
+	auto it = std::upper_bound(Column.begin(), Column.end(), Pos.y(),
+		[](int y, const QPair<QRect, CDockAreaWidget*>& Area)
+		{
+			return y < Area.first.top();
+		});
+	if (it == Column.begin())
+	{
+		return nullptr;
+	}
+
+	--it;
+	return it->first.contains(Pos) ? it->second : nullptr;
 }
 
 
@@ -538,8 +904,14 @@ void DockContainerWidgetPrivate::addDockAreasToList(const QList<CDockAreaWidget*
 void DockContainerWidgetPrivate::appendDockAreas(const QList<CDockAreaWidget*> NewDockAreas)
 {
 	DockAreas.append(NewDockAreas);
+	invalidateHitGrid();
+	invalidateTopLevelCache();
 	for (auto DockArea : NewDockAreas)
 	{
+		bool Visible = !DockArea->isHidden();
+		DockAreaVisibility.insert(DockArea, Visible);
+		VisibleDockAreaCount += Visible ? 1 : 0;
+		DockArea->installEventFilter(_this);
 		QObject::connect(DockArea,
 			&CDockAreaWidget::viewToggled,
 			_this,
@@ -557,8 +929,8 @@ void DockContainerWidgetPrivate::saveChildNodesState(QXmlStreamWriter& s, QWidge
 		s.writeStartElement("Splitter");
 		s.writeAttribute("Orientation", (Splitter->orientation() == Qt::Horizontal) ? "-" : "|");
 		s.writeAttribute("Count", QString::number(Splitter->count()));
-		qDebug() << "NodeSplitter orient: " << Splitter->orientation()
-			<< " WidgetCont: " << Splitter->count();
+		ADS_PRINT("NodeSplitter orient: " << Splitter->orientation()
+			<< " WidgetCont: " << Splitter->count());
 			for (int i = 0; i < Splitter->count(); ++i)
 			{
 				saveChildNodesState(s, Splitter->widget(i));
@@ -584,217 +956,295 @@ void DockContainerWidgetPrivate::saveChildNodesState(QXmlStreamWriter& s, QWidge
 
 
 //============================================================================
-bool DockContainerWidgetPrivate::restoreSplitter(QXmlStreamReader& s,
-	QWidget*& CreatedWidget, bool Testing)
+void DockContainerWidgetPrivate::saveChildNodesState(QDataStream& s, QWidget* Widget)
 {
-	bool Ok;
-	QString OrientationStr = s.attributes().value("Orientation").toString();
-	int Orientation;
-	if (OrientationStr.startsWith("-"))
+	QSplitter* Splitter = dynamic_cast<QSplitter*>(Widget);
+	if (Splitter)
 	{
-		Orientation = Qt::Horizontal;
+		s << quint8(internal::StateSplitterNode) << quint8(Splitter->orientation())
+		  << qint32(Splitter->count());
+		for (int i = 0; i < Splitter->count(); ++i)
+		{
+			saveChildNodesState(s, Splitter->widget(i));
+		}
+
+		for (auto Size : Splitter->sizes())
+		{
+			s << qint32(Size);
+		}
+		return;
 	}
-	else if (OrientationStr.startsWith("|"))
+
+	CDockAreaWidget* DockArea = dynamic_cast<CDockAreaWidget*>(Widget);
+	if (DockArea)
 	{
-		Orientation = Qt::Vertical;
+		DockArea->saveState(s);
 	}
 	else
 	{
-		return false;
+		// Keep the child count of the parent splitter consistent
+		s << quint8(internal::StateEmptyNode);
 	}
+}
 
-	int WidgetCount = s.attributes().value("Count").toInt(&Ok);
-	if (!Ok)
-	{
-		return false;
-	}
-	qDebug() << "Restore NodeSplitter Orientation: " <<  Orientation <<
-			" WidgetCount: " << WidgetCount;
-	QSplitter* Splitter = nullptr;
-	if (!Testing)
-	{
-		Splitter = newSplitter(static_cast<Qt::Orientation>(Orientation));
-	}
+
+//============================================================================
+QSplitter* DockContainerWidgetPrivate::restoreSplitter(
+	const internal::DockingState& State, const internal::LayoutNode& Node)
+{
+	QSplitter* Splitter = newSplitter(Node.Orientation);
 	bool Visible = false;
 	QList<int> Sizes;
-	while (s.readNextStartElement())
+	for (int i = 0; i < Node.Children.count(); ++i)
 	{
-		QWidget* ChildNode = nullptr;
-		bool Result = true;
-		if (s.name() == "Splitter")
-		{
-			Result = restoreSplitter(s, ChildNode, Testing);
-		}
-		else if (s.name() == "Area")
-		{
-			Result = restoreDockArea(s, ChildNode, Testing);
-		}
-		else if (s.name() == "Sizes")
-		{
-			QString sSizes = s.readElementText().trimmed();
-			qDebug() << "Sizes: " << sSizes;
-			QTextStream TextStream(&sSizes);
-			while (!TextStream.atEnd())
-			{
-				int value;
-				TextStream >> value;
-				Sizes.append(value);
-			}
-		}
-		else
-		{
-			s.skipCurrentElement();
-		}
-
-		if (!Result)
-		{
-			return false;
-		}
-
-		if (Testing || !ChildNode)
+		QWidget* ChildNode = restoreNode(State, Node.Children[i]);
+		if (!ChildNode)
 		{
 			continue;
 		}
 
-		qDebug() << "ChildNode isVisible " << ChildNode->isVisible()
-			<< " isVisibleTo " << ChildNode->isVisibleTo(Splitter);
 		Splitter->addWidget(ChildNode);
+		Sizes.append(Node.Sizes[i]);
 		Visible |= ChildNode->isVisibleTo(Splitter);
 	}
 
-	if (Sizes.count() != WidgetCount)
+	if (!Splitter->count())
 	{
-		return false;
+		delete Splitter;
+		return nullptr;
 	}
 
-	if (!Testing)
+	Splitter->setSizes(Sizes);
+	Splitter->setVisible(Visible);
+	return Splitter;
+}
+
+
+//============================================================================
+CDockAreaWidget* DockContainerWidgetPrivate::restoreDockArea(
+	const internal::LayoutNode& Node)
+{
+	// In incremental restore mode, an existing dock area with the same
+	// dock widgets is reused. Its dock widgets stay in place and only the
+	// dock area is moved into the new splitter
+	CDockAreaWidget* DockArea = ReusableDockAreas.isEmpty()
+		? nullptr : takeReusableDockArea(nodeDockWidgets(Node));
+	if (DockArea)
 	{
-		if (!Splitter->count())
+		updateNode(Node, DockArea);
+		QObject::disconnect(DockArea, &CDockAreaWidget::viewToggled, _this, nullptr);
+		appendDockAreas({DockArea});
+		return DockArea;
+	}
+
+	DockArea = new CDockAreaWidget(DockManager, _this);
+	for (const auto& DockWidgetState : Node.DockWidgets)
+	{
+		CDockWidget* DockWidget = DockManager->findDockWidget(DockWidgetState.Name);
+		if (!DockWidget)
 		{
-			delete Splitter;
-			Splitter = nullptr;
+			continue;
 		}
-		else
+
+		// We hide the DockArea here to prevent the short display (the flashing)
+		// of the dock areas during application startup
+		DockArea->hide();
+		DockArea->addDockWidget(DockWidget);
+		restoreDockWidgetState(DockWidget, DockWidgetState.Closed);
+	}
+
+	if (!DockArea->dockWidgetsCount())
+	{
+		delete DockArea;
+		return nullptr;
+	}
+
+	DockArea->setProperty("currentDockWidget", Node.CurrentDockWidget);
+	appendDockAreas({DockArea});
+	return DockArea;
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::restoreDockWidgetState(CDockWidget* DockWidget,
+	bool Closed)
+{
+	DockWidget->setToggleViewActionChecked(!Closed);
+	DockWidget->setClosedState(Closed);
+	DockWidget->setProperty("closed", Closed);
+	DockWidget->setProperty("dirty", false);
+}
+
+
+//============================================================================
+QList<CDockWidget*> DockContainerWidgetPrivate::nodeDockWidgets(
+	const internal::LayoutNode& Node) const
+{
+	QList<CDockWidget*> DockWidgets;
+	for (const auto& DockWidgetState : Node.DockWidgets)
+	{
+		CDockWidget* DockWidget = DockManager->findDockWidget(DockWidgetState.Name);
+		if (DockWidget)
 		{
-			Splitter->setSizes(Sizes);
-			Splitter->setVisible(Visible);
+			DockWidgets.append(DockWidget);
 		}
-		CreatedWidget = Splitter;
 	}
-	else
+	return DockWidgets;
+}
+
+
+//============================================================================
+bool DockContainerWidgetPrivate::isEmptyNode(const internal::DockingState& State,
+	int NodeIndex) const
+{
+	if (NodeIndex < 0)
 	{
-		CreatedWidget = nullptr;
+		return true;
 	}
 
-	return true;
+	const auto& Node = State.Nodes[NodeIndex];
+	switch (Node.Type)
+	{
+	case internal::LayoutNode::Splitter:
+		 return std::all_of(Node.Children.begin(), Node.Children.end(),
+			[&](int Child) {return isEmptyNode(State, Child);});
+
+	case internal::LayoutNode::Area:
+		 return nodeDockWidgets(Node).isEmpty();
+
+	default:
+		 return true;
+	}
 }
 
 
 //============================================================================
-bool DockContainerWidgetPrivate::restoreDockArea(QXmlStreamReader& s,
-	QWidget*& CreatedWidget, bool Testing)
+bool DockContainerWidgetPrivate::matchesNode(const internal::DockingState& State,
+	int NodeIndex, QWidget* Widget) const
 {
-	bool Ok;
-	int Tabs = s.attributes().value("Tabs").toInt(&Ok);
-	if (!Ok)
+	if (isEmptyNode(State, NodeIndex))
 	{
 		return false;
 	}
 
+	const auto& Node = State.Nodes[NodeIndex];
+	if (Node.Type == internal::LayoutNode::Area)
+	{
+		CDockAreaWidget* DockArea = qobject_cast<CDockAreaWidget*>(Widget);
+		return DockArea && DockArea->dockWidgets() == nodeDockWidgets(Node);
+	}
 
-	QString CurrentDockWidget = s.attributes().value("Current").toString();
-	qDebug() << "Restore NodeDockArea Tabs: " << Tabs << " Current: "
-			<< CurrentDockWidget;
-
-	CDockAreaWidget* DockArea = nullptr;
-	if (!Testing)
+	QSplitter* Splitter = qobject_cast<QSplitter*>(Widget);
+	if (!Splitter || Splitter->orientation() != Node.Orientation)
 	{
-		DockArea = new CDockAreaWidget(DockManager, _this);
+		return false;
 	}
 
-	while (s.readNextStartElement())
+	int WidgetIndex = 0;
+	for (auto Child : Node.Children)
 	{
-		if (s.name() != "Widget")
+		if (isEmptyNode(State, Child))
 		{
 			continue;
 		}
 
-		auto ObjectName = s.attributes().value("Name");
-		if (ObjectName.isEmpty())
+		if (WidgetIndex >= Splitter->count()
+		 || !matchesNode(State, Child, Splitter->widget(WidgetIndex)))
 		{
 			return false;
 		}
+		++WidgetIndex;
+	}
 
-		bool Closed = s.attributes().value("Closed").toInt(&Ok);
-		if (!Ok)
-		{
-			return false;
-		}
+	return WidgetIndex == Splitter->count();
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::updateNode(const internal::DockingState& State,
+	int NodeIndex, QWidget* Widget)
+{
+	const auto& Node = State.Nodes[NodeIndex];
+	if (Node.Type == internal::LayoutNode::Area)
+	{
+		updateNode(Node, qobject_cast<CDockAreaWidget*>(Widget));
+		return;
+	}
 
-		s.skipCurrentElement();
-		CDockWidget* DockWidget = DockManager->findDockWidget(ObjectName.toString());
-		if (!DockWidget || Testing)
+	QSplitter* Splitter = qobject_cast<QSplitter*>(Widget);
+	QList<int> Sizes;
+	int WidgetIndex = 0;
+	for (int i = 0; i < Node.Children.count(); ++i)
+	{
+		if (isEmptyNode(State, Node.Children[i]))
 		{
 			continue;
 		}
 
-		qDebug() << "Dock Widget found - parent " << DockWidget->parent();
-		// We hide the DockArea here to prevent the short display (the flashing)
-		// of the dock areas during application startup
-		DockArea->hide();
-		DockArea->addDockWidget(DockWidget);
-		DockWidget->setToggleViewActionChecked(!Closed);
-		DockWidget->setClosedState(Closed);
-		DockWidget->setProperty("closed", Closed);
-		DockWidget->setProperty("dirty", false);
+		updateNode(State, Node.Children[i], Splitter->widget(WidgetIndex));
+		Sizes.append(Node.Sizes[i]);
+		++WidgetIndex;
 	}
+	Splitter->setSizes(Sizes);
+}
 
-	if (Testing)
+
+//============================================================================
+void DockContainerWidgetPrivate::updateNode(const internal::LayoutNode& Node,
+	CDockAreaWidget* DockArea)
+{
+	for (const auto& DockWidgetState : Node.DockWidgets)
 	{
-		return true;
+		CDockWidget* DockWidget = DockManager->findDockWidget(DockWidgetState.Name);
+		if (DockWidget)
+		{
+			restoreDockWidgetState(DockWidget, DockWidgetState.Closed);
+		}
 	}
+	DockArea->setProperty("currentDockWidget", Node.CurrentDockWidget);
+}
 
-	if (!DockArea->dockWidgetsCount())
+
+//============================================================================
+CDockAreaWidget* DockContainerWidgetPrivate::takeReusableDockArea(
+	const QList<CDockWidget*>& DockWidgets)
+{
+	if (DockWidgets.isEmpty())
 	{
-		delete DockArea;
-		DockArea = nullptr;
+		return nullptr;
 	}
-	else
+
+	for (int i = 0; i < ReusableDockAreas.count(); ++i)
 	{
-		DockArea->setProperty("currentDockWidget", CurrentDockWidget);
-		appendDockAreas({DockArea});
+		CDockAreaWidget* DockArea = ReusableDockAreas[i];
+		if (DockArea->dockWidgets() == DockWidgets)
+		{
+			ReusableDockAreas.removeAt(i);
+			return DockArea;
+		}
 	}
 
-	CreatedWidget = DockArea;
-	return true;
+	return nullptr;
 }
 
 
 //============================================================================
-bool DockContainerWidgetPrivate::restoreChildNodes(QXmlStreamReader& s,
-	QWidget*& CreatedWidget, bool Testing)
+QWidget* DockContainerWidgetPrivate::restoreNode(
+	const internal::DockingState& State, int NodeIndex)
 {
-	bool Result = true;
-	while (s.readNextStartElement())
+	if (NodeIndex < 0)
 	{
-		if (s.name() == "Splitter")
-		{
-			Result = restoreSplitter(s, CreatedWidget, Testing);
-			qDebug() << "Splitter";
-		}
-		else if (s.name() == "Area")
-		{
-			Result = restoreDockArea(s, CreatedWidget, Testing);
-			qDebug() << "DockAreaWidget";
-		}
-		else
-		{
-			s.skipCurrentElement();
-			qDebug() << "Unknown element";
-		}
+		return nullptr;
 	}
 
-	return Result;
+	const auto& Node = State.Nodes[NodeIndex];
+	switch (Node.Type)
+	{
+	case internal::LayoutNode::Splitter: return restoreSplitter(State, Node);
+	case internal::LayoutNode::Area: return restoreDockArea(Node);
+	default:
+		 return nullptr;
+	}
 }
 
 
@@ -856,21 +1306,16 @@ void DockContainerWidgetPrivate::addDockArea(CDockAreaWidget* NewDockArea, DockW
 //============================================================================
 void DockContainerWidgetPrivate::dumpRecursive(int level, QWidget* widget)
 {
-#if defined(QT_DEBUG)
+#if ADS_PRINT_ENABLED
 	QSplitter* Splitter = dynamic_cast<QSplitter*>(widget);
 	QByteArray buf;
     buf.fill(' ', level * 4);
 	if (Splitter)
 	{
-		qDebug("%sSplitter %s v: %s c: %s",
-			(const char*)buf,
-			(Splitter->orientation() == Qt::Vertical) ? "--" : "|",
-			 Splitter->isHidden() ? " " : "v",
-			 QString::number(Splitter->count()).toStdString().c_str());
-		std::cout << (const char*)buf << "Splitter "
-			<< ((Splitter->orientation() == Qt::Vertical) ? "--" : "|") << " "
-			<< (Splitter->isHidden() ? " " : "v") << " "
-		    << QString::number(Splitter->count()).toStdString() << std::endl;
+		ADS_PRINT(buf.constData() << "Splitter"
+			<< ((Splitter->orientation() == Qt::Vertical) ? "--" : "|")
+			<< (Splitter->isHidden() ? " " : "v")
+			<< Splitter->count());
 		for (int i = 0; i < Splitter->count(); ++i)
 		{
 			dumpRecursive(level + 1, Splitter->widget(i));
@@ -883,19 +1328,19 @@ void DockContainerWidgetPrivate::dumpRecursive(int level, QWidget* widget)
 		{
 			return;
 		}
-		qDebug("%sDockArea", (const char*)buf);
-		std::cout << (const char*)buf
+		ADS_PRINT(buf.constData()
 			<< (DockArea->isHidden() ? " " : "v")
 			<< (DockArea->openDockWidgetsCount() > 0 ? " " : "c")
-			<< " DockArea" << std::endl;
+			<< "DockArea");
 		buf.fill(' ', (level + 1) * 4);
 		for (int i = 0; i < DockArea->dockWidgetsCount(); ++i)
 		{
-			std::cout << (const char*)buf << (i == DockArea->currentIndex() ? "*" : " ");
 			CDockWidget* DockWidget = DockArea->dockWidget(i);
-			std::cout << (DockWidget->isHidden() ? " " : "v");
-			std::cout << (DockWidget->isClosed() ? "c" : " ") << " ";
-			std::cout << DockWidget->windowTitle().toStdString() << std::endl;
+			ADS_PRINT(buf.constData()
+				<< (i == DockArea->currentIndex() ? "*" : " ")
+				<< (DockWidget->isHidden() ? " " : "v")
+				<< (DockWidget->isClosed() ? "c" : " ")
+				<< DockWidget->windowTitle());
 		}
 	}
 #else
@@ -923,12 +1368,12 @@ CDockAreaWidget* DockContainerWidgetPrivate::dockWidgetIntoDockArea(DockWidgetAr
 	int index = TargetAreaSplitter ->indexOf(TargetDockArea);
 	if (TargetAreaSplitter->orientation() == InsertParam.orientation())
 	{
-		qDebug() << "TargetAreaSplitter->orientation() == InsertParam.orientation()";
+		ADS_PRINT("TargetAreaSplitter->orientation() == InsertParam.orientation()");
 		TargetAreaSplitter->insertWidget(index + InsertParam.insertOffset(), NewDockArea);
 	}
 	else
 	{
-		qDebug() << "TargetAreaSplitter->orientation() != InsertParam.orientation()";
+		ADS_PRINT("TargetAreaSplitter->orientation() != InsertParam.orientation()");
 		QSplitter* NewSplitter = newSplitter(InsertParam.orientation());
 		NewSplitter->addWidget(TargetDockArea);
 		insertWidgetIntoSplitter(NewSplitter, NewDockArea, InsertParam.append());
@@ -1035,10 +1480,51 @@ bool CDockContainerWidget::event(QEvent *e)
 		d->zOrderIndex = ++zOrderCounter;
 	}
 
+	switch (e->type())
+	{
+	case QEvent::WindowActivate:
+	case QEvent::Show:
+	case QEvent::Hide:
+	case QEvent::Move:
+	case QEvent::Resize:
+		 if (d->DockManager)
+		 {
+			 d->DockManager->invalidateDockContainerOrder();
+		 }
+		 break;
+
+	default:
+		break;
+	}
+
 	return Result;
 }
 
 
+//============================================================================
+bool CDockContainerWidget::eventFilter(QObject* watched, QEvent* e)
+{
+	// The dock area geometries change if the user moves a splitter, if the
+	// container is resized or if dock areas are shown or hidden. The filter
+	// is also installed on the dock splitters, because a nested splitter may
+	// move without changing the local geometry of its dock areas
+	switch (e->type())
+	{
+	case QEvent::Move:
+	case QEvent::Resize:
+	case QEvent::Show:
+	case QEvent::Hide:
+		 d->invalidateHitGrid();
+		 break;
+
+	default:
+		break;
+	}
+
+	return QFrame::eventFilter(watched, e);
+}
+
+
 //============================================================================
 void CDockContainerWidget::addDockArea(CDockAreaWidget* DockAreaWidget,
 	DockWidgetArea area)
@@ -1056,9 +1542,16 @@ void CDockContainerWidget::addDockArea(CDockAreaWidget* DockAreaWidget,
 //============================================================================
 void CDockContainerWidget::removeDockArea(CDockAreaWidget* area)
 {
-	qDebug() << "CDockContainerWidget::removeDockArea";
+	ADS_PRINT("CDockContainerWidget::removeDockArea");
 	area->disconnect(this);
-	d->DockAreas.removeAll(area);
+	area->removeEventFilter(this);
+	d->DockAreas.removeOne(area);
+	d->invalidateHitGrid();
+	d->invalidateTopLevelCache();
+	if (d->DockAreaVisibility.take(area))
+	{
+		d->VisibleDockAreaCount--;
+	}
 	CDockSplitter* Splitter = internal::findParent<CDockSplitter*>(area);
 
 	// Remove are from parent splitter and recursively hide tree of parent
@@ -1072,6 +1565,17 @@ void CDockContainerWidget::removeDockArea(CDockAreaWidget* area)
 		d->LastAddedAreaCache[std::distance(cache, p)] = nullptr;
 	}
 
+	// In a batch update, the splitter tree is compacted only once when the
+	// update ends and the top level events are emitted by the dock manager.
+	// If multiple areas of this container are closed, the container does
+	// this itself at the end of the compaction batch
+	if (d->isUpdateDeferred() || d->CompactionBatchDepth)
+	{
+		d->SplitterCompactionPending = true;
+		d->emitDockAreasRemoved();
+		return;
+	}
+
 	// If splitter has more than 1 widgets, we are finished and can leave
 	if (Splitter->count() >  1)
 	{
@@ -1082,7 +1586,7 @@ void CDockContainerWidget::removeDockArea(CDockAreaWidget* area)
 	// avoid too many empty splitters
 	if (Splitter == d->RootSplitter)
 	{
-		qDebug() << "Removed from RootSplitter";
+		ADS_PRINT("Removed from RootSplitter");
 		// If splitter is empty, we are finished
 		if (!Splitter->count())
 		{
@@ -1104,11 +1608,11 @@ void CDockContainerWidget::removeDockArea(CDockAreaWidget* area)
 		QLayoutItem* li = d->Layout->replaceWidget(Splitter, ChildSplitter);
 		d->RootSplitter = ChildSplitter;
 		delete li;
-		qDebug() << "RootSplitter replaced by child splitter";
+		ADS_PRINT("RootSplitter replaced by child splitter");
 	}
 	else if (Splitter->count() == 1)
 	{
-		qDebug() << "Replacing splitter with content";
+		ADS_PRINT("Replacing splitter with content");
 		QSplitter* ParentSplitter = internal::findParent<QSplitter*>(Splitter);
 		auto Sizes = ParentSplitter->sizes();
 		QWidget* widget = Splitter->widget(0);
@@ -1125,7 +1629,9 @@ emitAndExit:
 	// Updated the title bar visibility of the dock widget if there is only
     // one single visible dock widget
 	CDockWidget::emitTopLevelEventForWidget(TopLevelWidget, true);
+#if (ADS_DEBUG_LEVEL > 0)
 	dumpLayout();
+#endif
 	d->emitDockAreasRemoved();
 }
 
@@ -1133,15 +1639,7 @@ emitAndExit:
 //============================================================================
 CDockAreaWidget* CDockContainerWidget::dockAreaAt(const QPoint& GlobalPos) const
 {
-	for (const auto& DockArea : d->DockAreas)
-	{
-		if (DockArea->isVisible() && DockArea->rect().contains(DockArea->mapFromGlobal(GlobalPos)))
-		{
-			return DockArea;
-		}
-	}
-
-	return nullptr;
+	return d->hitTest(mapFromGlobal(GlobalPos));
 }
 
 
@@ -1169,17 +1667,25 @@ int CDockContainerWidget::dockAreaCount() const
 //============================================================================
 int CDockContainerWidget::visibleDockAreaCount() const
 {
-	int Result = 0;
-	for (auto DockArea : d->DockAreas)
-	{
-		Result += DockArea->isHidden() ? 0 : 1;
-	}
+#if (ADS_DEBUG_LEVEL > 0)
+	Q_ASSERT_X(d->VisibleDockAreaCount == d->scanVisibleDockAreaCount(),
+		Q_FUNC_INFO, "Cached visible dock area count is out of sync");
+#endif
+	return d->VisibleDockAreaCount;
+}
 
-	return Result;
 
-	// TODO Cache or precalculate this to speed it up because it is used during
-	// movement of floating widget
-	//return d->visibleDockAreaCount();
+//============================================================================
+void CDockContainerWidget::onDockAreaVisibilityChanged(CDockAreaWidget* DockArea)
+{
+	d->updateDockAreaVisibility(DockArea);
+}
+
+
+//============================================================================
+void CDockContainerWidget::invalidateTopLevelDockWidget()
+{
+	d->invalidateTopLevelCache();
 }
 
 
@@ -1187,40 +1693,54 @@ int CDockContainerWidget::visibleDockAreaCount() const
 void CDockContainerWidget::dropFloatingWidget(CFloatingDockContainer* FloatingWidget,
 	const QPoint& TargetPos)
 {
-	qDebug() << "CDockContainerWidget::dropFloatingWidget";
+	ADS_PRINT("CDockContainerWidget::dropFloatingWidget");
 	CDockAreaWidget* DockArea = dockAreaAt(TargetPos);
 	auto dropArea = InvalidDockWidgetArea;
-	auto ContainerDropArea = d->DockManager->containerOverlay()->dropAreaUnderCursor();
-	CDockWidget* FloatingTopLevelDockWidget = FloatingWidget->topLevelDockWidget();
-	CDockWidget* TopLevelDockWidget = topLevelDockWidget();
-
+	auto ContainerDropArea = d->DockManager->containerOverlay()->dropAreaAt(TargetPos);
 	if (DockArea)
 	{
 		auto dropOverlay = d->DockManager->dockAreaOverlay();
 		dropOverlay->setAllowedAreas(AllDockAreas);
-		dropArea = dropOverlay->showOverlay(DockArea);
+		dropArea = dropOverlay->showOverlay(DockArea, TargetPos);
 		if (ContainerDropArea != InvalidDockWidgetArea &&
 			ContainerDropArea != dropArea)
 		{
 			dropArea = InvalidDockWidgetArea;
 		}
-
-		if (dropArea != InvalidDockWidgetArea)
-		{
-			qDebug() << "Dock Area Drop Content: " << dropArea;
-			d->dropIntoSection(FloatingWidget, DockArea, dropArea);
-		}
 	}
 
 	// mouse is over container
 	if (InvalidDockWidgetArea == dropArea)
 	{
+		DockArea = nullptr;
 		dropArea = ContainerDropArea;
-		qDebug()  << "Container Drop Content: " << dropArea;
-		if (dropArea != InvalidDockWidgetArea)
-		{
-			d->dropIntoContainer(FloatingWidget, dropArea);
-		}
+	}
+
+	dropFloatingWidget(FloatingWidget, DockArea, dropArea);
+}
+
+
+//============================================================================
+void CDockContainerWidget::dropFloatingWidget(CFloatingDockContainer* FloatingWidget,
+	CDockAreaWidget* TargetArea, DockWidgetArea DropArea)
+{
+	CDockWidget* FloatingTopLevelDockWidget = FloatingWidget->topLevelDockWidget();
+	CDockWidget* TopLevelDockWidget = topLevelDockWidget();
+
+	if (InvalidDockWidgetArea == DropArea)
+	{
+		return;
+	}
+
+	if (TargetArea)
+	{
+		ADS_PRINT("Dock Area Drop Content: " << DropArea);
+		d->dropIntoSection(FloatingWidget, TargetArea, DropArea);
+	}
+	else
+	{
+		ADS_PRINT("Container Drop Content: " << DropArea);
+		d->dropIntoContainer(FloatingWidget, DropArea);
 	}
 
 	// If there was a top level widget before the drop, then it is not top
@@ -1258,8 +1778,8 @@ QList<CDockAreaWidget*> CDockContainerWidget::openedDockAreas() const
 //============================================================================
 void CDockContainerWidget::saveState(QXmlStreamWriter& s) const
 {
-	qDebug() << "CDockContainerWidget::saveState isFloating "
-		<< isFloating();
+	ADS_PRINT("CDockContainerWidget::saveState isFloating "
+		<< isFloating());
 
 	s.writeStartElement("Container");
 	s.writeAttribute("Floating", QString::number(isFloating() ? 1 : 0));
@@ -1279,64 +1799,141 @@ void CDockContainerWidget::saveState(QXmlStreamWriter& s) const
 
 
 //============================================================================
-bool CDockContainerWidget::restoreState(QXmlStreamReader& s, bool Testing)
+void CDockContainerWidget::restoreState(const internal::DockingState& State,
+	const internal::ContainerState& Container)
 {
-	bool IsFloating = s.attributes().value("Floating").toInt();
-	qDebug() << "Restore CDockContainerWidget Floating" << IsFloating;
-
-	QWidget*NewRootSplitter {};
-	if (!Testing)
-	{
-		d->VisibleDockAreaCount = -1;// invalidate the dock area count
-		d->DockAreas.clear();
-		std::fill(std::begin(d->LastAddedAreaCache),std::end(d->LastAddedAreaCache), nullptr);
-	}
-
-	if (IsFloating)
-	{
-		qDebug() << "Restore floating widget";
-		if (!s.readNextStartElement() || s.name() != "Geometry")
-		{
-			return false;
-		}
-
-		QByteArray GeometryString = s.readElementText(QXmlStreamReader::ErrorOnUnexpectedElement).toLocal8Bit();
-		QByteArray Geometry = QByteArray::fromHex(GeometryString);
-		if (Geometry.isEmpty())
+	ADS_PRINT("Restore CDockContainerWidget Floating" << Container.Floating);
+	bool Incremental = d->DockManager->configFlags().testFlag(CDockManager::IncrementalStateRestore);
+	if (Incremental && (d->matchesNode(State, Container.RootNode, d->RootSplitter)
+	 || (d->isEmptyNode(State, Container.RootNode) && !d->RootSplitter->count())))
+	{
+		// The layout did not change - so we keep all existing dock areas and
+		// splitters and only apply the sizes and the dock widget states
+		ADS_PRINT("Restore CDockContainerWidget: Layout unchanged");
+		if (Container.Floating)
 		{
-			return false;
+			floatingWidget()->restoreGeometry(Container.Geometry);
 		}
 
-		if (!Testing)
+		if (d->RootSplitter->count())
 		{
-			CFloatingDockContainer* FloatingWidget = floatingWidget();
-			FloatingWidget->restoreGeometry(Geometry);
+			d->updateNode(State, Container.RootNode, d->RootSplitter);
 		}
+		return;
 	}
 
-	if (!d->restoreChildNodes(s, NewRootSplitter, Testing))
+	if (Incremental)
 	{
-		return false;
+		d->ReusableDockAreas = d->DockAreas;
 	}
-
-	if (Testing)
+	d->VisibleDockAreaCount = 0;
+	d->DockAreaVisibility.clear();
+	d->DockAreas.clear();
+	d->invalidateHitGrid();
+	d->invalidateTopLevelCache();
+	std::fill(std::begin(d->LastAddedAreaCache),std::end(d->LastAddedAreaCache), nullptr);
+	if (Container.Floating)
 	{
-		return true;
+		floatingWidget()->restoreGeometry(Container.Geometry);
 	}
 
-	// If the root splitter is empty, rostoreChildNodes returns a 0 pointer
-	// and we need to create a new empty root splitter
+	// If the root node is empty, restoreNode returns a 0 pointer
+	// and we need to create a new empty root splitter. If the root node is
+	// a dock area, we put it into a new root splitter
+	QWidget* RootWidget = d->restoreNode(State, Container.RootNode);
+	d->ReusableDockAreas.clear();
+	QSplitter* NewRootSplitter = qobject_cast<QSplitter*>(RootWidget);
 	if (!NewRootSplitter)
 	{
 		NewRootSplitter = d->newSplitter(Qt::Horizontal);
+		if (RootWidget)
+		{
+			NewRootSplitter->addWidget(RootWidget);
+		}
 	}
 
 	d->Layout->replaceWidget(d->RootSplitter, NewRootSplitter);
 	QSplitter* OldRoot = d->RootSplitter;
-	d->RootSplitter = dynamic_cast<QSplitter*>(NewRootSplitter);
+	d->RootSplitter = NewRootSplitter;
 	OldRoot->deleteLater();
+}
+
 
-	return true;
+//============================================================================
+void CDockContainerWidget::saveState(QDataStream& s) const
+{
+	s << isFloating();
+	if (isFloating())
+	{
+		s << floatingWidget()->saveGeometry();
+	}
+	d->saveChildNodesState(s, d->RootSplitter);
+}
+
+
+//============================================================================
+void CDockContainerWidget::markTitleBarVisibilityOutdated()
+{
+	d->TitleBarUpdatePending = true;
+}
+
+
+//============================================================================
+void CDockContainerWidget::beginCompactionBatch()
+{
+	d->CompactionBatchDepth++;
+}
+
+
+//============================================================================
+void CDockContainerWidget::endCompactionBatch()
+{
+	if (--d->CompactionBatchDepth || !d->SplitterCompactionPending
+	 || d->isUpdateDeferred())
+	{
+		return;
+	}
+
+	d->compactSplitterTree();
+	CDockWidget::emitTopLevelEventForWidget(topLevelDockWidget(), true);
+#if (ADS_DEBUG_LEVEL > 0)
+	dumpLayout();
+#endif
+}
+
+
+//============================================================================
+void CDockContainerWidget::flushDeferredUpdates()
+{
+	if (!d->DockAreasAddedPending && !d->DockAreasRemovedPending
+	 && !d->SplitterCompactionPending && !d->TitleBarUpdatePending)
+	{
+		return;
+	}
+
+	if (d->SplitterCompactionPending)
+	{
+		d->compactSplitterTree();
+	}
+
+	d->TitleBarUpdatePending = false;
+	for (auto DockArea : d->DockAreas)
+	{
+		DockArea->updateTitleBarVisibility();
+	}
+
+	d->onVisibleDockAreaCountChanged();
+	if (d->DockAreasRemovedPending)
+	{
+		d->DockAreasRemovedPending = false;
+		emit dockAreasRemoved();
+	}
+
+	if (d->DockAreasAddedPending)
+	{
+		d->DockAreasAddedPending = false;
+		emit dockAreasAdded();
+	}
 }
 
 
@@ -1362,13 +1959,9 @@ void CDockContainerWidget::createRootSplitter()
 //============================================================================
 void CDockContainerWidget::dumpLayout()
 {
-#if (ADS_DEBUG_LEVEL > 0)
-	qDebug("\n\nDumping layout --------------------------");
-	std::cout << "\n\nDumping layout --------------------------" << std::endl;
+	ADS_PRINT("Dumping layout --------------------------");
 	d->dumpRecursive(0, d->RootSplitter);
-	qDebug("--------------------------\n\n");
-	std::cout << "--------------------------\n\n" << std::endl;
-#endif
+	ADS_PRINT("--------------------------");
 }
 
 
@@ -1382,56 +1975,23 @@ CDockAreaWidget* CDockContainerWidget::lastAddedDockAreaWidget(DockWidgetArea ar
 //============================================================================
 bool CDockContainerWidget::hasTopLevelDockWidget() const
 {
-	if (!isFloating())
-	{
-		return false;
-	}
-
-	auto DockAreas = openedDockAreas();
-	if (DockAreas.count() != 1)
-	{
-		return false;
-	}
-
-	return DockAreas[0]->openDockWidgetsCount() == 1;
+	return topLevelDockWidget() != nullptr;
 }
 
 
 //============================================================================
 CDockWidget* CDockContainerWidget::topLevelDockWidget() const
 {
-	auto TopLevelDockArea = topLevelDockArea();
-	if (!TopLevelDockArea)
-	{
-		return nullptr;
-	}
-
-	auto DockWidgets = TopLevelDockArea->openedDockWidgets();
-	if (DockWidgets.count() != 1)
-	{
-		return nullptr;
-	}
-
-	return DockWidgets[0];
-
+	d->updateTopLevelCache();
+	return d->CachedTopLevelDockWidget;
 }
 
 
 //============================================================================
 CDockAreaWidget* CDockContainerWidget::topLevelDockArea() const
 {
-	if (!isFloating())
-	{
-		return nullptr;
-	}
-
-	auto DockAreas = openedDockAreas();
-	if (DockAreas.count() != 1)
-	{
-		return nullptr;
-	}
-
-	return DockAreas[0];
+	d->updateTopLevelCache();
+	return d->CachedTopLevelDockArea;
 }
 
 
@@ -1471,6 +2031,7 @@ CFloatingDockContainer* CDockContainerWidget::floatingWidget() const
 //============================================================================
 void CDockContainerWidget::closeOtherAreas(CDockAreaWidget* KeepOpenArea)
 {
+	beginCompactionBatch();
 	for (const auto DockArea : d->DockAreas)
 	{
 		if (DockArea != KeepOpenArea && DockArea->features().testFlag(CDockWidget::DockWidgetClosable))
@@ -1478,6 +2039,7 @@ void CDockContainerWidget::closeOtherAreas(CDockAreaWidget* KeepOpenArea)
 			DockArea->closeArea();
 		}
 	}
+	endCompactionBatch();
 }
 
 
@@ -36,10 +36,15 @@
 #include "DockWidget.h"
 
 class QXmlStreamWriter;
-class QXmlStreamReader;
+class QDataStream;
 
 namespace ads
 {
+namespace internal
+{
+struct DockingState;
+struct ContainerState;
+}
 class DockContainerWidgetPrivate;
 class CDockAreaWidget;
 class CDockWidget;
@@ -63,14 +68,50 @@ private:
 	friend class CDockAreaWidget;
 	friend struct DockAreaWidgetPrivate;
 	friend class CFloatingDockContainer;
+	friend struct FloatingDragPreviewPrivate;
 	friend struct FloatingDockContainerPrivate;
 	friend class CDockWidget;
 protected:
 	/**
-	 * Handles activation events to update zOrderIndex
+	 * Handles activation events to update zOrderIndex and informs the
+	 * dock manager about z order and geometry changes
 	 */
 	virtual bool event(QEvent *e) override;
 
+	/**
+	 * Watches the geometry of the dock areas to invalidate the dock area
+	 * hit test grid
+	 */
+	virtual bool eventFilter(QObject* watched, QEvent* e) override;
+
+	/**
+	 * Emits the signals and does the title bar updates that have been
+	 * deferred while the dock manager was in a batch update.
+	 * \see CDockManager::beginUpdate()
+	 */
+	void flushDeferredUpdates();
+
+	/**
+	 * Called by dock areas, that skipped a title bar visibility update
+	 * during a batch update. The title bars are updated by
+	 * flushDeferredUpdates()
+	 */
+	void markTitleBarVisibilityOutdated();
+
+	/**
+	 * Starts a batch of dock area removals. Until the matching
+	 * endCompactionBatch() call, removed dock areas are only hidden and the
+	 * splitter tree is compacted once at the end. Calls can be nested.
+	 * Unlike CDockManager::beginUpdate(), this only affects this container
+	 */
+	void beginCompactionBatch();
+
+	/**
+	 * Ends a batch of dock area removals and compacts the splitter tree,
+	 * if dock areas have been removed
+	 */
+	void endCompactionBatch();
+
 	/**
 	 * Access function for the internal root splitter
 	 */
@@ -86,6 +127,14 @@ protected:
 	 */
 	void dropFloatingWidget(CFloatingDockContainer* FloatingWidget, const QPoint& TargetPos);
 
+	/**
+	 * Drops the floating widget into the given target dock area or into
+	 * this container, if TargetArea is a nullptr. The drop position is given
+	 * by DropArea.
+	 */
+	void dropFloatingWidget(CFloatingDockContainer* FloatingWidget,
+		CDockAreaWidget* TargetArea, DockWidgetArea DropArea);
+
 	/**
 	 * Adds the given dock area to this container widget
 	 */
@@ -96,18 +145,36 @@ protected:
 	 */
 	void removeDockArea(CDockAreaWidget* area);
 
+	/**
+	 * Dock area widgets call this function if their visibility changed to
+	 * keep the cached visible dock area count up to date
+	 */
+	void onDockAreaVisibilityChanged(CDockAreaWidget* DockArea);
+
+	/**
+	 * Dock areas and dock widgets call this function if dock widgets are
+	 * added, removed, opened or closed. This invalidates the cached
+	 * results of topLevelDockWidget() and topLevelDockArea()
+	 */
+	void invalidateTopLevelDockWidget();
+
 	/**
 	 * Saves the state into the given stream
 	 */
 	void saveState(QXmlStreamWriter& Stream) const;
 
 	/**
-	 * Restores the state from given stream.
-	 * If Testing is true, the function only parses the data from the given
-	 * stream but does not restore anything. You can use this check for
-	 * faulty files before you start restoring the state
+	 * Saves the state into the given binary stream
+	 */
+	void saveState(QDataStream& Stream) const;
+
+	/**
+	 * Restores the state of the given container from the decoded state tree.
+	 * The state tree has already been validated by the dock manager, so
+	 * there is no testing mode
 	 */
-	bool restoreState(QXmlStreamReader& Stream, bool Testing);
+	void restoreState(const internal::DockingState& State,
+		const internal::ContainerState& Container);
 
 	/**
 	 * This function returns the last added dock area widget for the given
@@ -184,7 +251,9 @@ public:
 
 	/**
 	 * Returns the dock area at teh given global position or 0 if there is no
-	 * dock area at this position
+	 * dock area at this position.
+	 * The function uses a cached grid of the dock area geometries that is
+	 * rebuilt only if dock areas are added, removed, moved or resized.
 	 */
 	CDockAreaWidget* dockAreaAt(const QPoint& GlobalPos) const;
 
@@ -206,7 +275,9 @@ public:
 	int dockAreaCount() const;
 
 	/**
-	 * Returns the number of visible dock areas
+	 * Returns the number of visible dock areas.
+	 * The count is cached and updated incrementally if dock areas are added,
+	 * removed or if their visibility changes.
 	 */
 	int visibleDockAreaCount() const;
 
@@ -216,7 +287,9 @@ public:
 	bool isFloating() const;
 
 	/**
-	 * Dumps the layout for debugging purposes
+	 * Dumps the layout to the "ads" logging category for debugging purposes.
+	 * The library only calls this function itself, if ADS_DEBUG_LEVEL is
+	 * greater than 0.
 	 */
 	void dumpLayout();
 
@@ -0,0 +1,117 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockInstrumentation.cpp
+/// \date   14.10.2026
+/// \brief  Implementation of CDockInstrumentation class
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockInstrumentation.h"
+
+namespace ads
+{
+QAtomicPointer<CDockInstrumentation> CDockInstrumentation::s_Instance;
+
+
+//============================================================================
+CDockInstrumentation::~CDockInstrumentation()
+{
+	s_Instance.testAndSetOrdered(this, nullptr);
+}
+
+
+//============================================================================
+void CDockInstrumentation::beginScope(eScope Scope)
+{
+	Q_UNUSED(Scope);
+}
+
+
+//============================================================================
+void CDockInstrumentation::endScope(eScope Scope, qint64 ElapsedNanoSecs)
+{
+	Q_UNUSED(Scope);
+	Q_UNUSED(ElapsedNanoSecs);
+}
+
+
+//============================================================================
+void CDockInstrumentation::counterChanged(eCounter Counter, quint64 Value)
+{
+	Q_UNUSED(Counter);
+	Q_UNUSED(Value);
+}
+
+
+//============================================================================
+void CDockInstrumentation::resetCounters()
+{
+	for (auto& Counter : m_Counters)
+	{
+		Counter = 0;
+	}
+}
+
+
+//============================================================================
+const char* CDockInstrumentation::scopeName(eScope Scope)
+{
+	switch (Scope)
+	{
+	case RestoreDecompress: return "RestoreDecompress";
+	case RestoreParse: return "RestoreParse";
+	case RestoreApply: return "RestoreApply";
+	case RestoreDockAreasIndices: return "RestoreDockAreasIndices";
+	case EmitTopLevelEvents: return "EmitTopLevelEvents";
+	case DragUpdate: return "DragUpdate";
+	case OverlayRepaint: return "OverlayRepaint";
+	case TabSwitch: return "TabSwitch";
+	case SplitterResize: return "SplitterResize";
+	default: return "";
+	}
+}
+
+
+//============================================================================
+const char* CDockInstrumentation::counterName(eCounter Counter)
+{
+	switch (Counter)
+	{
+	case WidgetsCreated: return "WidgetsCreated";
+	case ReparentOperations: return "ReparentOperations";
+	case OverlayRepaints: return "OverlayRepaints";
+	default: return "";
+	}
+}
+
+
+//============================================================================
+void CDockInstrumentation::setInstance(CDockInstrumentation* Instrumentation)
+{
+	s_Instance.storeRelease(Instrumentation);
+}
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF DockInstrumentation.cpp
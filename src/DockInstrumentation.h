@@ -0,0 +1,209 @@
+#ifndef DockInstrumentationH
+#define DockInstrumentationH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockInstrumentation.h
+/// \date   14.10.2026
+/// \brief  Declaration of CDockInstrumentation class
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include <QElapsedTimer>
+#include <QAtomicPointer>
+
+#include "ads_globals.h"
+
+namespace ads
+{
+/**
+ * Interface for tracing backends that want to know, where the docking
+ * system spends its time.
+ * Install an instance with CDockManager::setInstrumentation(). While no
+ * instrumentation is installed, each hook only costs a null pointer check.
+ * If the library is compiled with ADS_NO_INSTRUMENTATION, all hooks are
+ * removed completely.
+ * Scopes of the decoding phases may be reported from a worker thread, if
+ * the state is decoded in the background. All other scopes and all counters
+ * are reported from the GUI thread. The installed instance is published
+ * atomically, so it may be changed while a background restore is running.
+ * An instance must stay alive until all scopes that use it have ended.
+ */
+class ADS_EXPORT CDockInstrumentation
+{
+public:
+	/**
+	 * The instrumented hot path scopes
+	 */
+	enum eScope
+	{
+		RestoreDecompress,      //!< Decompression of a compressed XML state
+		RestoreParse,           //!< Parsing and validation of a saved state
+		RestoreApply,           //!< Applying the decoded state to the dock containers
+		RestoreDockAreasIndices,//!< Restoring the current tabs of all dock areas
+		EmitTopLevelEvents,     //!< Emitting the top level events after a restore or batch update
+		DragUpdate,             //!< Moving a dragged floating widget and updating the drop overlays
+		OverlayRepaint,         //!< Painting a drop overlay
+		TabSwitch,              //!< Switching the current tab of a dock area
+		SplitterResize,         //!< Relayout of the content of a splitter in adaptive opaque resize mode
+		ScopeCount
+	};
+
+	/**
+	 * The event counters
+	 */
+	enum eCounter
+	{
+		WidgetsCreated,         //!< Dock areas, splitters and floating widgets created by the library
+		ReparentOperations,     //!< Dock widgets that have been moved to another parent widget
+		OverlayRepaints,        //!< Paint events of the drop overlays
+		CounterCount
+	};
+
+	/**
+	 * Virtual Destructor.
+	 * If this is the installed instrumentation, it is uninstalled.
+	 */
+	virtual ~CDockInstrumentation();
+
+	/**
+	 * Called when the given scope is entered
+	 */
+	virtual void beginScope(eScope Scope);
+
+	/**
+	 * Called when the given scope is left. ElapsedNanoSecs is the time
+	 * that has been spent in the scope
+	 */
+	virtual void endScope(eScope Scope, qint64 ElapsedNanoSecs);
+
+	/**
+	 * Called each time, the given counter has been incremented
+	 */
+	virtual void counterChanged(eCounter Counter, quint64 Value);
+
+	/**
+	 * Returns the current value of the given counter
+	 */
+	quint64 counter(eCounter Counter) const {return m_Counters[Counter];}
+
+	/**
+	 * Sets all counters to 0
+	 */
+	void resetCounters();
+
+	/**
+	 * Returns the name of the given scope, i.e. for the zone names of a
+	 * tracing backend
+	 */
+	static const char* scopeName(eScope Scope);
+
+	/**
+	 * Returns the name of the given counter
+	 */
+	static const char* counterName(eCounter Counter);
+
+	/**
+	 * Returns the installed instrumentation or a nullptr
+	 */
+	static CDockInstrumentation* instance() {return s_Instance.loadAcquire();}
+
+	/**
+	 * Installs the given instrumentation. Pass a nullptr to disable the
+	 * instrumentation. The docking system does not take ownership.
+	 */
+	static void setInstance(CDockInstrumentation* Instrumentation);
+
+	/**
+	 * Increments the given counter of the installed instrumentation
+	 */
+	static void count(eCounter Counter)
+	{
+		auto Instrumentation = instance();
+		if (Instrumentation)
+		{
+			Instrumentation->increment(Counter);
+		}
+	}
+
+private:
+	static QAtomicPointer<CDockInstrumentation> s_Instance;
+	quint64 m_Counters[CounterCount] = {};
+
+	void increment(eCounter Counter)
+	{
+		counterChanged(Counter, ++m_Counters[Counter]);
+	}
+};
+
+
+namespace internal
+{
+/**
+ * Reports a timed scope to the installed instrumentation.
+ * The scope starts in the constructor and ends in the destructor.
+ */
+class CInstrumentationScope
+{
+private:
+	CDockInstrumentation* m_Instrumentation;
+	CDockInstrumentation::eScope m_Scope;
+	QElapsedTimer m_Timer;
+
+public:
+	CInstrumentationScope(CDockInstrumentation::eScope Scope)
+		: m_Instrumentation(CDockInstrumentation::instance()),
+		  m_Scope(Scope)
+	{
+		if (m_Instrumentation)
+		{
+			m_Instrumentation->beginScope(m_Scope);
+			m_Timer.start();
+		}
+	}
+
+	~CInstrumentationScope()
+	{
+		if (m_Instrumentation)
+		{
+			m_Instrumentation->endScope(m_Scope, m_Timer.nsecsElapsed());
+		}
+	}
+};
+} // namespace internal
+} // namespace ads
+
+
+#ifdef ADS_NO_INSTRUMENTATION
+#define ADS_INSTRUMENT_SCOPE(Scope)
+#define ADS_INSTRUMENT_COUNT(Counter)
+#else
+#define ADS_INSTRUMENT_CONCAT_(a, b) a##b
+#define ADS_INSTRUMENT_CONCAT(a, b) ADS_INSTRUMENT_CONCAT_(a, b)
+#define ADS_INSTRUMENT_SCOPE(Scope) ads::internal::CInstrumentationScope \
+	ADS_INSTRUMENT_CONCAT(InstrumentationScope, __LINE__)(ads::CDockInstrumentation::Scope)
+#define ADS_INSTRUMENT_COUNT(Counter) ads::CDockInstrumentation::count(ads::CDockInstrumentation::Counter)
+#endif
+
+//---------------------------------------------------------------------------
+#endif // DockInstrumentationH
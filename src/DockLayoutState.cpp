@@ -0,0 +1,724 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockLayoutState.cpp
+/// \date   14.10.2026
+/// \brief  Implementation of the docking state decoding functions
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockLayoutState.h"
+
+#include <QXmlStreamReader>
+#include <QDataStream>
+#include <QStringList>
+#include <QDebug>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QMutexLocker>
+#include <QFile>
+#include <QFileDevice>
+
+#include "ads_globals.h"
+#include "DockInstrumentation.h"
+
+namespace ads
+{
+namespace internal
+{
+static const int MaxBinarySplitterDepth = 64;///< maximum nesting of splitters in a binary state
+
+static int readXmlLayoutNode(QXmlStreamReader& s, DockingState& State);
+
+
+//============================================================================
+static int readXmlDockArea(QXmlStreamReader& s, DockingState& State)
+{
+	bool Ok;
+	s.attributes().value("Tabs").toInt(&Ok);
+	if (!Ok)
+	{
+		return -1;
+	}
+
+	LayoutNode Node;
+	Node.Type = LayoutNode::Area;
+	Node.CurrentDockWidget = s.attributes().value("Current").toString();
+	while (s.readNextStartElement())
+	{
+		if (s.name() != "Widget")
+		{
+			s.skipCurrentElement();
+			continue;
+		}
+
+		DockWidgetState DockWidget;
+		DockWidget.Name = s.attributes().value("Name").toString();
+		DockWidget.Closed = s.attributes().value("Closed").toInt(&Ok);
+		if (DockWidget.Name.isEmpty() || !Ok)
+		{
+			return -1;
+		}
+
+		s.skipCurrentElement();
+		Node.DockWidgets.append(DockWidget);
+	}
+
+	State.Nodes.append(Node);
+	return State.Nodes.count() - 1;
+}
+
+
+//============================================================================
+static int readXmlSplitter(QXmlStreamReader& s, DockingState& State)
+{
+	bool Ok;
+	QStringRef OrientationStr = s.attributes().value("Orientation");
+	Qt::Orientation Orientation;
+	if (OrientationStr.startsWith("-"))
+	{
+		Orientation = Qt::Horizontal;
+	}
+	else if (OrientationStr.startsWith("|"))
+	{
+		Orientation = Qt::Vertical;
+	}
+	else
+	{
+		return -1;
+	}
+
+	int WidgetCount = s.attributes().value("Count").toInt(&Ok);
+	if (!Ok)
+	{
+		return -1;
+	}
+
+	// We reserve the node index before we read the child nodes. This
+	// ensures, that child nodes always have a higher index than their parent
+	int NodeIndex = State.Nodes.count();
+	State.Nodes.append(LayoutNode());
+	QVector<int> Children;
+	QList<int> Sizes;
+	while (s.readNextStartElement())
+	{
+		if (s.name() == "Splitter" || s.name() == "Area")
+		{
+			int ChildIndex = readXmlLayoutNode(s, State);
+			if (ChildIndex < 0)
+			{
+				return -1;
+			}
+			Children.append(ChildIndex);
+		}
+		else if (s.name() == "Sizes")
+		{
+			const QStringList SizeList = s.readElementText().split(' ',
+				QString::SkipEmptyParts);
+			for (const auto& Size : SizeList)
+			{
+				Sizes.append(Size.toInt(&Ok));
+				if (!Ok)
+				{
+					return -1;
+				}
+			}
+		}
+		else
+		{
+			s.skipCurrentElement();
+		}
+	}
+
+	if (Sizes.count() != WidgetCount || Children.count() != WidgetCount)
+	{
+		return -1;
+	}
+
+	LayoutNode& Node = State.Nodes[NodeIndex];
+	Node.Type = LayoutNode::Splitter;
+	Node.Orientation = Orientation;
+	Node.Children = Children;
+	Node.Sizes = Sizes;
+	return NodeIndex;
+}
+
+
+//============================================================================
+static int readXmlLayoutNode(QXmlStreamReader& s, DockingState& State)
+{
+	if (s.name() == "Splitter")
+	{
+		return readXmlSplitter(s, State);
+	}
+	else if (s.name() == "Area")
+	{
+		return readXmlDockArea(s, State);
+	}
+
+	return -1;
+}
+
+
+//============================================================================
+static bool readXmlContainer(QXmlStreamReader& s, DockingState& State)
+{
+	ContainerState Container;
+	Container.Floating = s.attributes().value("Floating").toInt();
+	if (Container.Floating)
+	{
+		if (!s.readNextStartElement() || s.name() != "Geometry")
+		{
+			return false;
+		}
+
+		QByteArray GeometryString = s.readElementText(QXmlStreamReader::ErrorOnUnexpectedElement).toLocal8Bit();
+		Container.Geometry = QByteArray::fromHex(GeometryString);
+		if (Container.Geometry.isEmpty())
+		{
+			return false;
+		}
+	}
+
+	while (s.readNextStartElement())
+	{
+		if (s.name() == "Splitter" || s.name() == "Area")
+		{
+			// If there are multiple root nodes, the last one wins
+			Container.RootNode = readXmlLayoutNode(s, State);
+			if (Container.RootNode < 0)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			s.skipCurrentElement();
+		}
+	}
+
+	State.Containers.append(Container);
+	return true;
+}
+
+
+//============================================================================
+static bool readXmlState(QXmlStreamReader& s, DockingState& State)
+{
+	s.readNextStartElement();
+	if (s.name() != "QtAdvancedDockingSystem")
+	{
+		return false;
+	}
+
+	bool Ok;
+	State.Version = s.attributes().value("Version").toInt(&Ok);
+	if (!Ok)
+	{
+		return false;
+	}
+
+	while (s.readNextStartElement())
+	{
+		if (s.name() != "Container")
+		{
+			s.skipCurrentElement();
+			continue;
+		}
+
+		if (!readXmlContainer(s, State))
+		{
+			return false;
+		}
+	}
+
+	return !s.hasError();
+}
+
+
+//============================================================================
+static bool readXmlState(const QByteArray& Xml, DockingState& State)
+{
+	QXmlStreamReader s(Xml);
+	return readXmlState(s, State);
+}
+
+
+//============================================================================
+/**
+ * Returns true, if Count entries of at least one byte each can still be
+ * read from the given stream. This rejects corrupted counts before any
+ * entry is allocated
+ */
+static bool isValidBinaryCount(QDataStream& s, qint32 Count)
+{
+	return Count >= 0 && Count <= s.device()->bytesAvailable();
+}
+
+
+//============================================================================
+static int readBinaryLayoutNode(QDataStream& s, DockingState& State,
+	int Depth = 0)
+{
+	quint8 Tag;
+	s >> Tag;
+	if (s.status() != QDataStream::Ok)
+	{
+		return -1;
+	}
+
+	int NodeIndex = State.Nodes.count();
+	State.Nodes.append(LayoutNode());
+	switch (Tag)
+	{
+	case StateEmptyNode:
+		 return NodeIndex;
+
+	case StateSplitterNode:
+		{
+			quint8 Orientation;
+			qint32 WidgetCount;
+			s >> Orientation >> WidgetCount;
+			if (s.status() != QDataStream::Ok || !isValidBinaryCount(s, WidgetCount)
+			 || Depth >= MaxBinarySplitterDepth
+			 || (Orientation != Qt::Horizontal && Orientation != Qt::Vertical))
+			{
+				return -1;
+			}
+
+			QVector<int> Children;
+			for (int i = 0; i < WidgetCount; ++i)
+			{
+				int ChildIndex = readBinaryLayoutNode(s, State, Depth + 1);
+				if (ChildIndex < 0)
+				{
+					return -1;
+				}
+				Children.append(ChildIndex);
+			}
+
+			QList<int> Sizes;
+			for (int i = 0; i < WidgetCount; ++i)
+			{
+				qint32 Size;
+				s >> Size;
+				if (s.status() != QDataStream::Ok)
+				{
+					return -1;
+				}
+				Sizes.append(Size);
+			}
+
+			LayoutNode& Node = State.Nodes[NodeIndex];
+			Node.Type = LayoutNode::Splitter;
+			Node.Orientation = static_cast<Qt::Orientation>(Orientation);
+			Node.Children = Children;
+			Node.Sizes = Sizes;
+		}
+		break;
+
+	case StateAreaNode:
+		{
+			qint32 Tabs;
+			QString CurrentDockWidget;
+			s >> Tabs >> CurrentDockWidget;
+			if (s.status() != QDataStream::Ok || !isValidBinaryCount(s, Tabs))
+			{
+				return -1;
+			}
+
+			QVector<DockWidgetState> DockWidgets;
+			for (int i = 0; i < Tabs; ++i)
+			{
+				DockWidgetState DockWidget;
+				s >> DockWidget.Name >> DockWidget.Closed;
+				if (s.status() != QDataStream::Ok)
+				{
+					return -1;
+				}
+				DockWidgets.append(DockWidget);
+			}
+
+			LayoutNode& Node = State.Nodes[NodeIndex];
+			Node.Type = LayoutNode::Area;
+			Node.CurrentDockWidget = CurrentDockWidget;
+			Node.DockWidgets = DockWidgets;
+		}
+		break;
+
+	default:
+		 return -1;
+	}
+
+	return (s.status() == QDataStream::Ok) ? NodeIndex : -1;
+}
+
+
+//============================================================================
+static bool readBinaryState(const QByteArray& Data, DockingState& State)
+{
+	QDataStream Header(Data);
+	Header.setVersion(QDataStream::Qt_5_5);
+	quint32 Magic;
+	quint32 FormatVersion;
+	qint32 Version;
+	QByteArray Payload;
+	quint16 Checksum;
+	Header >> Magic >> FormatVersion >> Version >> Payload >> Checksum;
+	if (Header.status() != QDataStream::Ok || Magic != BinaryStateMagic
+	 || FormatVersion != BinaryStateFormatVersion
+	 || Checksum != qChecksum(Payload.constData(), Payload.size()))
+	{
+		return false;
+	}
+
+	State.Version = Version;
+	QDataStream s(Payload);
+	s.setVersion(QDataStream::Qt_5_5);
+	qint32 ContainerCount;
+	s >> ContainerCount;
+	if (s.status() != QDataStream::Ok || !isValidBinaryCount(s, ContainerCount))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < ContainerCount; ++i)
+	{
+		ContainerState Container;
+		s >> Container.Floating;
+		if (Container.Floating)
+		{
+			s >> Container.Geometry;
+		}
+
+		Container.RootNode = readBinaryLayoutNode(s, State);
+		if (Container.RootNode < 0)
+		{
+			return false;
+		}
+		State.Containers.append(Container);
+	}
+
+	return true;
+}
+
+
+//============================================================================
+static bool isBinaryState(const QByteArray& Data)
+{
+	QDataStream s(Data);
+	quint32 Magic = 0;
+	s >> Magic;
+	return Magic == BinaryStateMagic;
+}
+
+
+//============================================================================
+static bool validateDockingState(bool Result, DockingState& State)
+{
+	if (!Result || !isValidDockingState(State))
+	{
+		ADS_PRINT("readDockingState: Invalid docking state");
+		State = DockingState();
+		return false;
+	}
+
+	return true;
+}
+
+
+//============================================================================
+bool readDockingState(const QByteArray& Data, DockingState& State)
+{
+	State = DockingState();
+	if (Data.isEmpty())
+	{
+		return false;
+	}
+
+	bool Binary = isBinaryState(Data);
+	QByteArray Xml = Data;
+	if (!Binary && !Data.startsWith("<?xml"))
+	{
+		ADS_INSTRUMENT_SCOPE(RestoreDecompress);
+		Xml = qUncompress(Data);
+	}
+
+	ADS_INSTRUMENT_SCOPE(RestoreParse);
+	bool Result;
+	if (Binary)
+	{
+		Result = readBinaryState(Data, State);
+	}
+	else
+	{
+		Result = readXmlState(Xml, State);
+	}
+
+	return validateDockingState(Result, State);
+}
+
+
+//============================================================================
+bool readDockingState(QIODevice* Device, DockingState& State)
+{
+	State = DockingState();
+	if (!Device || !Device->isReadable())
+	{
+		return false;
+	}
+
+	// Files are mapped into memory, so the saved state is never copied
+	// into a buffer
+	QFileDevice* File = qobject_cast<QFileDevice*>(Device);
+	if (File && !File->isSequential())
+	{
+		qint64 Pos = File->pos();
+		qint64 Size = File->size() - Pos;
+		uchar* Memory = (Size > 0) ? File->map(Pos, Size) : nullptr;
+		if (Memory)
+		{
+			bool Result = readDockingState(QByteArray::fromRawData(
+				reinterpret_cast<const char*>(Memory), int(Size)), State);
+			File->unmap(Memory);
+			File->seek(Pos + Size);
+			return Result;
+		}
+	}
+
+	// Plain XML is parsed directly from the device
+	if (Device->peek(5) == "<?xml")
+	{
+		ADS_INSTRUMENT_SCOPE(RestoreParse);
+		QXmlStreamReader s(Device);
+		return validateDockingState(readXmlState(s, State), State);
+	}
+
+	return readDockingState(Device->readAll(), State);
+}
+
+
+//============================================================================
+bool isValidDockingState(const DockingState& State)
+{
+	if (State.Containers.isEmpty())
+	{
+		return false;
+	}
+
+	for (const auto& Container : State.Containers)
+	{
+		if (Container.Floating && Container.Geometry.isEmpty())
+		{
+			return false;
+		}
+
+		if (Container.RootNode >= State.Nodes.count())
+		{
+			return false;
+		}
+	}
+
+	for (int i = 0; i < State.Nodes.count(); ++i)
+	{
+		const auto& Node = State.Nodes[i];
+		if (Node.Type == LayoutNode::Splitter)
+		{
+			if (Node.Sizes.count() != Node.Children.count())
+			{
+				return false;
+			}
+
+			// Child nodes always have a higher index than their parent node.
+			// This guarantees that the tree does not contain any cycles
+			for (auto Child : Node.Children)
+			{
+				if (Child <= i || Child >= State.Nodes.count())
+				{
+					return false;
+				}
+			}
+		}
+		else if (Node.Type == LayoutNode::Area)
+		{
+			for (const auto& DockWidget : Node.DockWidgets)
+			{
+				if (DockWidget.Name.isEmpty())
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+
+//============================================================================
+qint64 estimatedMemoryUsage(const DockingState& State)
+{
+	qint64 Result = sizeof(DockingState);
+	for (const auto& Container : State.Containers)
+	{
+		Result += sizeof(ContainerState) + Container.Geometry.capacity();
+	}
+
+	for (const auto& Node : State.Nodes)
+	{
+		Result += sizeof(LayoutNode);
+		Result += Node.Children.capacity() * sizeof(int);
+		Result += Node.Sizes.count() * sizeof(void*);
+		Result += Node.CurrentDockWidget.capacity() * sizeof(QChar);
+		for (const auto& DockWidget : Node.DockWidgets)
+		{
+			Result += sizeof(DockWidgetState) + DockWidget.Name.capacity() * sizeof(QChar);
+		}
+	}
+
+	return Result;
+}
+
+
+/**
+ * The thread pool task that runs a docking state decoder
+ */
+class DockingStateDecoderTask : public QRunnable
+{
+private:
+	QSharedPointer<DockingStateDecoder> m_Decoder;
+
+public:
+	DockingStateDecoderTask(const QSharedPointer<DockingStateDecoder>& Decoder)
+		: m_Decoder(Decoder)
+	{}
+
+	virtual void run() override
+	{
+		m_Decoder->run();
+	}
+};
+
+
+//============================================================================
+DockingStateDecoder::DockingStateDecoder(const QByteArray& Data,
+	const QString& FileName)
+	: m_Data(Data),
+	  m_FileName(FileName)
+{
+
+}
+
+
+//============================================================================
+void DockingStateDecoder::run()
+{
+	DockingState State;
+	bool Valid = false;
+	if (!m_FileName.isEmpty())
+	{
+		QFile File(m_FileName);
+		if (File.open(QIODevice::ReadOnly))
+		{
+			Valid = readDockingState(&File, State);
+		}
+		else
+		{
+			ADS_PRINT("DockingStateDecoder: Cannot open" << m_FileName);
+		}
+	}
+	else
+	{
+		Valid = readDockingState(m_Data, State);
+	}
+
+	QMutexLocker Lock(&m_Mutex);
+	m_State = State;
+	m_Valid = Valid;
+	m_Data.clear();
+	m_Finished = true;
+	m_FinishedCondition.wakeAll();
+}
+
+
+//============================================================================
+QSharedPointer<DockingStateDecoder> DockingStateDecoder::start(DockingStateDecoder* Decoder)
+{
+	QSharedPointer<DockingStateDecoder> Result(Decoder);
+	QThreadPool::globalInstance()->start(new DockingStateDecoderTask(Result));
+	return Result;
+}
+
+
+//============================================================================
+QSharedPointer<DockingStateDecoder> DockingStateDecoder::start(const QByteArray& Data)
+{
+	return start(new DockingStateDecoder(Data, QString()));
+}
+
+
+//============================================================================
+QSharedPointer<DockingStateDecoder> DockingStateDecoder::startFile(const QString& FileName)
+{
+	return start(new DockingStateDecoder(QByteArray(), FileName));
+}
+
+
+//============================================================================
+bool DockingStateDecoder::isFinished() const
+{
+	QMutexLocker Lock(&m_Mutex);
+	return m_Finished;
+}
+
+
+//============================================================================
+void DockingStateDecoder::waitForFinished() const
+{
+	QMutexLocker Lock(&m_Mutex);
+	while (!m_Finished)
+	{
+		m_FinishedCondition.wait(&m_Mutex);
+	}
+}
+
+
+//============================================================================
+bool DockingStateDecoder::isValid() const
+{
+	waitForFinished();
+	return m_Valid;
+}
+
+
+//============================================================================
+const DockingState& DockingStateDecoder::state() const
+{
+	waitForFinished();
+	return m_State;
+}
+} // namespace internal
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF DockLayoutState.cpp
@@ -0,0 +1,194 @@
+#ifndef DockLayoutStateH
+#define DockLayoutStateH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockLayoutState.h
+/// \date   14.10.2026
+/// \brief  Declaration of the decoded docking state tree
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSharedPointer>
+
+class QIODevice;
+
+namespace ads
+{
+namespace internal
+{
+/**
+ * The saved state of a single dock widget in a dock area
+ */
+struct DockWidgetState
+{
+	QString Name;
+	bool Closed = false;
+};
+
+/**
+ * A node of the decoded layout tree.
+ * A node is either a splitter with child nodes or a dock area with dock
+ * widgets. Empty nodes are placeholders for splitter children that do not
+ * contain any dock area. The child nodes are stored as indices into the
+ * Nodes array of the DockingState.
+ */
+struct LayoutNode
+{
+	enum eType
+	{
+		Empty,
+		Splitter,
+		Area
+	};
+
+	eType Type = Empty;
+	Qt::Orientation Orientation = Qt::Horizontal;
+	QVector<int> Children;
+	QList<int> Sizes;
+	QString CurrentDockWidget;
+	QVector<DockWidgetState> DockWidgets;
+};
+
+/**
+ * The saved state of a dock container.
+ * RootNode is -1 if the container does not contain any dock area.
+ */
+struct ContainerState
+{
+	bool Floating = false;
+	QByteArray Geometry;
+	int RootNode = -1;
+};
+
+/**
+ * The decoded and validated state of the complete docking system.
+ * The first container is the dock manager, all other containers are
+ * floating widgets.
+ */
+struct DockingState
+{
+	int Version = 0;
+	QVector<ContainerState> Containers;
+	QVector<LayoutNode> Nodes;
+};
+
+/**
+ * Decodes the given saved state into the given docking state tree.
+ * The function detects the binary format, compressed XML and plain XML
+ * and parses the data in a single pass. The decoded tree is validated
+ * before the function returns.
+ * Returns false, if the data is not a valid docking system state.
+ */
+bool readDockingState(const QByteArray& Data, DockingState& State);
+
+/**
+ * Decodes the saved state from the current position of the given device
+ * up to its end.
+ * Files are mapped into memory instead of being read into a buffer and
+ * plain XML is parsed directly from the device.
+ */
+bool readDockingState(QIODevice* Device, DockingState& State);
+
+/**
+ * Returns true, if the given decoded state is structurally valid. That
+ * means, all node indices are valid, the tree contains no cycles, the
+ * number of splitter sizes matches the number of splitter children, all
+ * dock widget names are non empty and all floating containers have a
+ * geometry.
+ */
+bool isValidDockingState(const DockingState& State);
+
+/**
+ * Returns the estimated number of bytes that the given decoded state
+ * occupies in memory
+ */
+qint64 estimatedMemoryUsage(const DockingState& State);
+
+
+/**
+ * Decodes a saved state in a worker thread of the global thread pool.
+ * The decoding does not touch any widget, so it can run in parallel to
+ * the GUI thread. The decoded state is only accessible after the decoder
+ * finished.
+ */
+class DockingStateDecoder
+{
+private:
+	QByteArray m_Data;
+	QString m_FileName;
+	DockingState m_State;
+	bool m_Valid = false;
+	bool m_Finished = false;
+	mutable QMutex m_Mutex;
+	mutable QWaitCondition m_FinishedCondition;
+	friend class DockingStateDecoderTask;
+
+	DockingStateDecoder(const QByteArray& Data, const QString& FileName);
+	void run();
+	static QSharedPointer<DockingStateDecoder> start(DockingStateDecoder* Decoder);
+
+public:
+	/**
+	 * Starts decoding of the given saved state in the global thread pool
+	 */
+	static QSharedPointer<DockingStateDecoder> start(const QByteArray& Data);
+
+	/**
+	 * Starts reading and decoding of the saved state in the given file in
+	 * the global thread pool
+	 */
+	static QSharedPointer<DockingStateDecoder> startFile(const QString& FileName);
+
+	/**
+	 * Returns true, if the worker thread finished decoding
+	 */
+	bool isFinished() const;
+
+	/**
+	 * Blocks until the worker thread finished decoding
+	 */
+	void waitForFinished() const;
+
+	/**
+	 * Waits for the decoder and returns true, if the decoded state is a
+	 * valid docking system state
+	 */
+	bool isValid() const;
+
+	/**
+	 * Waits for the decoder and returns the decoded state
+	 */
+	const DockingState& state() const;
+};
+} // namespace internal
+} // namespace ads
+
+//---------------------------------------------------------------------------
+#endif // DockLayoutStateH
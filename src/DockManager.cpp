@@ -37,25 +37,63 @@
 #include <QMainWindow>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QPair>
 #include <QVariant>
 #include <QDebug>
 #include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QUrl>
 #include <QAction>
 #include <QXmlStreamWriter>
-#include <QXmlStreamReader>
+#include <QDataStream>
 #include <QSettings>
 #include <QMenu>
 #include <QApplication>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QPointer>
 
 #include "FloatingDockContainer.h"
 #include "DockOverlay.h"
 #include "DockWidget.h"
 #include "ads_globals.h"
 #include "DockAreaWidget.h"
+#include "DockLayoutState.h"
+#include "DockInstrumentation.h"
 
 
 namespace ads
 {
+static const int AsyncDecodePollInterval = 5;///< poll interval in ms while decoding
+static const int AsyncRestoreTimeSlice = 10;///< maximum time in ms per content creation slice
+static CDockManager::eStyleSheetMode StyleSheetMode = CDockManager::WidgetStyleSheet;
+static bool ApplicationStyleSheetApplied = false;
+
+/**
+ * A perspective stored in the dock manager.
+ * Data is the saved state that is written by savePerspectives(). State is
+ * the decoded state tree that is used by openPerspective(). If the
+ * perspective cache limit is exceeded, the decoded state of the least
+ * recently used perspectives is released and decoded again on demand.
+ * Perspectives that are loaded from a perspective directory have no Data.
+ * They are read from FileName when they are opened the first time.
+ */
+struct PerspectiveEntry
+{
+	QByteArray Data;
+	QString FileName;
+	internal::DockingState State;
+	bool Decoded = false;
+	qint64 DecodedSize = 0;
+	quint64 LastUsed = 0;
+};
+
 /**
  * Private data class of CDockManager class (pimpl)
  */
@@ -66,13 +104,35 @@ struct DockManagerPrivate
 	QList<CDockContainerWidget*> Containers;
 	CDockOverlay* ContainerOverlay;
 	CDockOverlay* DockAreaOverlay;
-	QMap<QString, CDockWidget*> DockWidgetsMap;
-	QMap<QString, QByteArray> Perspectives;
+	QVector<CDockWidget*> DockWidgets;
+	QHash<QString, CDockWidget*> DockWidgetsByName;
+	QHash<int, CDockWidget*> DockWidgetsById;
+	int NextDockWidgetId = 0;
+	QMap<QString, PerspectiveEntry> Perspectives;
+	qint64 PerspectiveCacheLimit = 0;
+	quint64 PerspectiveUseCounter = 0;
 	QMap<QString, QMenu*> ViewMenuGroups;
 	QMenu* ViewMenu;
 	CDockManager::eViewMenuInsertionOrder MenuInsertionOrder = CDockManager::MenuAlphabeticallySorted;
 	bool RestoringState = false;
 	CDockManager::ConfigFlags ConfigFlags = CDockManager::DefaultConfig;
+	int MaxDragUpdateRate = 60;
+	QVector<QPair<QRect, CDockContainerWidget*>> ZOrderedContainers;
+	bool ZOrderedContainersDirty = true;
+	QTimer* VisibilityUpdateTimer = nullptr;
+	QVector<QPair<QRect, CDockContainerWidget*>> VisibilityContainers;
+	QList<QPointer<CDockWidget>> VisibilityUpdateWidgets;
+	int UpdateDepth = 0;
+	bool UpdatesEnabledBeforeUpdate = true;
+	bool RestoreIncremental = false;
+	bool RestoreWasHidden = false;
+	bool FloatingWidgetsShowDeferred = false;
+	QSharedPointer<internal::DockingStateDecoder> AsyncDecoder;
+	int AsyncVersion = 0;
+	QTimer* AsyncRestoreTimer = nullptr;
+	QList<QPointer<CDockWidget>> AsyncPendingContents;
+	int AsyncContentCount = 0;
+	bool AsyncContentPhase = false;
 
 	/**
 	 * Private data constructor
@@ -80,23 +140,111 @@ struct DockManagerPrivate
 	DockManagerPrivate(CDockManager* _public);
 
 	/**
-	 * Checks if the given data stream is a valid docking system state
-	 * file.
+	 * Restores the given decoded state tree.
+	 * The version number is compared with the version stored in the state.
+	 * If they do not match, the state is left unchanged and the function
+	 * returns false
+	 */
+	bool restoreState(const internal::DockingState& State, int version);
+
+	/**
+	 * Hides the dock manager, emits restoringState() and applies the
+	 * given state. The dock widget contents are not created.
+	 * Returns false, if the state cannot be restored
+	 */
+	bool beginRestore(const internal::DockingState& State, int version);
+
+	/**
+	 * Shows the dock manager again after beginRestore()
+	 */
+	void showRestoredState();
+
+	/**
+	 * Finishes the restore and emits stateRestored()
+	 */
+	void endRestore();
+
+	/**
+	 * Runs the next step of an asynchronous restore. While the state is
+	 * decoded, this function polls the decoder. After the state has been
+	 * applied, the function creates the pending dock widget contents until
+	 * the time slice is used up
+	 */
+	void asyncRestoreStep();
+
+	/**
+	 * Ends the content creation phase of an asynchronous restore and emits
+	 * asyncRestoreFinished(). Contents that have not been created yet,
+	 * are created by their dock widgets when they are shown
+	 */
+	void finishAsyncContents();
+
+	/**
+	 * Returns the current dock widgets of all dock areas whose content still
+	 * needs to be created by their widget factory
+	 */
+	QList<QPointer<CDockWidget>> pendingDockWidgetContents() const;
+
+	/**
+	 * Applies the given decoded state tree to all dock containers
+	 */
+	void applyState(const internal::DockingState& State);
+
+	/**
+	 * Creates a perspective entry for the given saved state and decodes it.
+	 * Returns false, if the state is not a valid docking system state
+	 */
+	bool insertPerspective(const QString& Name, const QByteArray& Data);
+
+	/**
+	 * Decodes the state of the given perspective if it is not decoded yet
+	 */
+	bool decodePerspective(PerspectiveEntry& Entry);
+
+	/**
+	 * Returns the saved state of the given perspective. For perspectives
+	 * that are stored in a file, the file is read
+	 */
+	QByteArray perspectiveData(const PerspectiveEntry& Entry) const;
+
+	/**
+	 * Writes the XML state to the given device.
+	 * Returns false, if the state could not be written completely
 	 */
-	bool checkFormat(const QByteArray &state, int version);
+	bool writeXmlState(QIODevice* Device, int Version) const;
 
 	/**
-	 * Restores the state
+	 * Releases the decoded state of the least recently used perspectives
+	 * until the memory usage is below the perspective cache limit.
+	 * The decoded state of the perspective Keep is never released.
 	 */
-	bool restoreStateFromXml(const QByteArray &state, int version, bool Testing = internal::Restore);
+	void trimPerspectiveCache(const QString& Keep = QString());
 
 	/**
-	 * Restore state
+	 * Deletes the floating widgets that are not used by the restored state
 	 */
-	bool restoreState(const QByteArray &state, int version);
+	void deleteUnusedFloatingWidgets(int DockContainerCount);
+
+	/**
+	 * Adds the given dock widget to the dock widget registry and assigns
+	 * a numeric id, if the dock widget does not have one yet
+	 */
+	void registerDockWidget(CDockWidget* DockWidget);
+
+	/**
+	 * Removes the given dock widget from the dock widget registry
+	 */
+	void unregisterDockWidget(CDockWidget* DockWidget);
 
 	void restoreDockWidgetsOpenState();
 	void restoreDockAreasIndices();
+
+	/**
+	 * Creates the content of all open dock widgets that are the current
+	 * dock widget of their dock area, if the content is created via a
+	 * widget factory
+	 */
+	void createCurrentDockWidgetContents();
 	void emitTopLevelEvents();
 
 	void hideFloatingWidgets()
@@ -108,21 +256,76 @@ struct DockManagerPrivate
 		}
 	}
 
+	/**
+	 * Shows all floating widgets with opened dock areas and hides all other
+	 * floating widgets in one pass. While a state is restored, the floating
+	 * widgets ignore show and hide requests, so each native window is
+	 * mapped or unmapped at most once with its final geometry
+	 */
+	void showFloatingWidgets()
+	{
+		for (auto FloatingWidget : FloatingWidgets)
+		{
+			auto DockContainer = FloatingWidget->dockContainer();
+			bool Visible = Containers.contains(DockContainer)
+				&& !DockContainer->openedDockAreas().isEmpty();
+			FloatingWidget->setUpdatesEnabled(true);
+			FloatingWidget->setVisible(Visible);
+		}
+	}
+
 	void markDockWidgetsDirty()
 	{
-		for (auto DockWidget : DockWidgetsMap)
+		for (auto DockWidget : DockWidgets)
 		{
 			DockWidget->setProperty("dirty", true);
 		}
 	}
 
 	/**
-	 * Restores the container with the given index
+	 * Rebuilds the list of visible containers with their global frame
+	 * geometries. The list is sorted by z order index from front to back.
+	 * Containers with an equal z order index keep the order in the
+	 * Containers list
 	 */
-	bool restoreContainer(int Index, QXmlStreamReader& stream, bool Testing);
+	void updateZOrderedContainers()
+	{
+		ZOrderedContainers.clear();
+		for (auto Container : Containers)
+		{
+			if (Container->isVisible())
+			{
+				ZOrderedContainers.append(qMakePair(QRect(
+					Container->mapToGlobal(QPoint(0, 0)), Container->size()), Container));
+			}
+		}
+
+		std::stable_sort(ZOrderedContainers.begin(), ZOrderedContainers.end(),
+			[](const QPair<QRect, CDockContainerWidget*>& a, const QPair<QRect, CDockContainerWidget*>& b)
+			{
+				return a.second->zOrderIndex() > b.second->zOrderIndex();
+			});
+		ZOrderedContainersDirty = false;
+	}
+
+	/**
+	 * Updates the content visibility of the dock widgets that may have
+	 * changed since the last update. These are the dock widgets of all
+	 * containers behind the first container whose geometry, minimized state
+	 * or z order changed and the dock widgets that requested an update
+	 */
+	void updateDockWidgetVisibility();
+
+	/**
+	 * Restores the container with the given index from the decoded
+	 * state tree
+	 */
+	void restoreContainer(int Index, const internal::DockingState& State,
+		const internal::ContainerState& Container);
 
 	/**
-	 * Loads the stylesheet
+	 * Applies the default stylesheet depending on the global stylesheet
+	 * mode
 	 */
 	void loadStylesheet();
 
@@ -144,111 +347,278 @@ DockManagerPrivate::DockManagerPrivate(CDockManager* _public) :
 //============================================================================
 void DockManagerPrivate::loadStylesheet()
 {
-	QString Result;
-#ifdef Q_OS_LINUX
-    QFile StyleSheetFile(":ads/stylesheets/default_linux.css");
-#else
-	QFile StyleSheetFile(":ads/stylesheets/default.css");
-#endif
-	StyleSheetFile.open(QIODevice::ReadOnly);
-	QTextStream StyleSheetStream(&StyleSheetFile);
-	Result = StyleSheetStream.readAll();
-	StyleSheetFile.close();
-	_this->setStyleSheet(Result);
+	switch (StyleSheetMode)
+	{
+	case CDockManager::WidgetStyleSheet:
+		_this->setStyleSheet(CDockManager::defaultStyleSheet());
+		break;
+
+	case CDockManager::ApplicationStyleSheet:
+		// The stylesheet is parsed and applied only once for all dock
+		// managers
+		if (!ApplicationStyleSheetApplied)
+		{
+			qApp->setStyleSheet(qApp->styleSheet() + CDockManager::defaultStyleSheet());
+			ApplicationStyleSheetApplied = true;
+		}
+		break;
+
+	case CDockManager::NoStyleSheet:
+		break;
+	}
 }
 
 
 //============================================================================
-bool DockManagerPrivate::restoreContainer(int Index, QXmlStreamReader& stream, bool Testing)
+void DockManagerPrivate::restoreContainer(int Index,
+	const internal::DockingState& State, const internal::ContainerState& Container)
 {
-	if (Testing)
+	if (Index >= Containers.count())
 	{
-		Index = 0;
+		CFloatingDockContainer* FloatingWidget = new CFloatingDockContainer(_this);
+		FloatingWidget->restoreState(State, Container);
+		return;
 	}
 
-	bool Result = false;
-	if (Index >= Containers.count())
+	auto DockContainer = Containers[Index];
+	if (DockContainer->isFloating())
 	{
-		CFloatingDockContainer* FloatingWidget = new CFloatingDockContainer(_this);
-		Result = FloatingWidget->restoreState(stream, Testing);
+		DockContainer->floatingWidget()->restoreState(State, Container);
 	}
 	else
 	{
-		qDebug() << "d->Containers[i]->restoreState ";
-		auto Container = Containers[Index];
-		if (Container->isFloating())
-		{
-			Result = Container->floatingWidget()->restoreState(stream, Testing);
-		}
-		else
+		DockContainer->restoreState(State, Container);
+	}
+}
+
+
+//============================================================================
+void DockManagerPrivate::applyState(const internal::DockingState& State)
+{
+	ADS_INSTRUMENT_SCOPE(RestoreApply);
+	int DockContainerCount = 0;
+	for (const auto& Container : State.Containers)
+	{
+		restoreContainer(DockContainerCount, State, Container);
+		DockContainerCount++;
+	}
+
+	// Delete remaining empty floating widgets
+	deleteUnusedFloatingWidgets(DockContainerCount);
+}
+
+
+//============================================================================
+bool DockManagerPrivate::insertPerspective(const QString& Name, const QByteArray& Data)
+{
+	PerspectiveEntry Entry;
+	Entry.Data = Data;
+	if (!decodePerspective(Entry))
+	{
+		return false;
+	}
+
+	Entry.LastUsed = ++PerspectiveUseCounter;
+	Perspectives.insert(Name, Entry);
+	trimPerspectiveCache(Name);
+	return true;
+}
+
+
+//============================================================================
+bool DockManagerPrivate::decodePerspective(PerspectiveEntry& Entry)
+{
+	if (Entry.Decoded)
+	{
+		return true;
+	}
+
+	if (Entry.Data.isEmpty() && !Entry.FileName.isEmpty())
+	{
+		QFile File(Entry.FileName);
+		if (!File.open(QIODevice::ReadOnly)
+		 || !internal::readDockingState(&File, Entry.State))
 		{
-			Result = Container->restoreState(stream, Testing);
+			return false;
 		}
 	}
+	else if (!internal::readDockingState(Entry.Data, Entry.State))
+	{
+		return false;
+	}
 
-	return Result;
+	Entry.Decoded = true;
+	Entry.DecodedSize = internal::estimatedMemoryUsage(Entry.State);
+	return true;
 }
 
 
 //============================================================================
-bool DockManagerPrivate::checkFormat(const QByteArray &state, int version)
+QByteArray DockManagerPrivate::perspectiveData(const PerspectiveEntry& Entry) const
 {
-    return restoreStateFromXml(state, version, internal::RestoreTesting);
+	if (!Entry.Data.isEmpty() || Entry.FileName.isEmpty())
+	{
+		return Entry.Data;
+	}
+
+	QFile File(Entry.FileName);
+	if (!File.open(QIODevice::ReadOnly))
+	{
+		ADS_PRINT("perspectiveData: Cannot open " << Entry.FileName);
+		return QByteArray();
+	}
+	return File.readAll();
 }
 
 
 //============================================================================
-bool DockManagerPrivate::restoreStateFromXml(const QByteArray &state,  int version,
-	bool Testing)
+bool DockManagerPrivate::writeXmlState(QIODevice* Device, int Version) const
 {
-    if (state.isEmpty())
-    {
-        return false;
-    }
-    QXmlStreamReader s(state);
-    s.readNextStartElement();
-    if (s.name() != "QtAdvancedDockingSystem")
-    {
-    	return false;
-    }
-    qDebug() << s.attributes().value("Version");
-    bool ok;
-    int v = s.attributes().value("Version").toInt(&ok);
-    if (!ok || v != version)
-    {
-    	return false;
-    }
+    QXmlStreamWriter s(Device);
+	s.setAutoFormatting(ConfigFlags.testFlag(CDockManager::XmlAutoFormattingEnabled));
+    s.writeStartDocument();
+		s.writeStartElement("QtAdvancedDockingSystem");
+		s.writeAttribute("Version", QString::number(Version));
+		s.writeAttribute("Containers", QString::number(Containers.count()));
+		for (auto Container : Containers)
+		{
+			Container->saveState(s);
+		}
 
-    bool Result = true;
-    int  DockContainers = s.attributes().value("Containers").toInt();
-    qDebug() << DockContainers;
-    int DockContainerCount = 0;
-    while (s.readNextStartElement())
-    {
-    	if (s.name() == "Container")
-    	{
-    		Result = restoreContainer(DockContainerCount, s, Testing);
-			if (!Result)
+		s.writeEndElement();
+    s.writeEndDocument();
+    return !s.hasError();
+}
+
+
+//============================================================================
+void DockManagerPrivate::trimPerspectiveCache(const QString& Keep)
+{
+	if (PerspectiveCacheLimit <= 0)
+	{
+		return;
+	}
+
+	qint64 MemoryUsage = _this->perspectivesMemoryUsage();
+	while (MemoryUsage > PerspectiveCacheLimit)
+	{
+		auto LeastRecentlyUsed = Perspectives.end();
+		for (auto it = Perspectives.begin(); it != Perspectives.end(); ++it)
+		{
+			if (!it->Decoded || it.key() == Keep)
 			{
-				break;
+				continue;
 			}
-			DockContainerCount++;
-    	}
-    }
 
-    if (!Testing)
-    {
-		// Delete remaining empty floating widgets
-		int FloatingWidgetIndex = DockContainerCount - 1;
-		int DeleteCount = FloatingWidgets.count() - FloatingWidgetIndex;
-		for (int i = 0; i < DeleteCount; ++i)
+			if (LeastRecentlyUsed == Perspectives.end()
+			 || it->LastUsed < LeastRecentlyUsed->LastUsed)
+			{
+				LeastRecentlyUsed = it;
+			}
+		}
+
+		if (LeastRecentlyUsed == Perspectives.end())
 		{
-			FloatingWidgets[FloatingWidgetIndex + i]->deleteLater();
-			_this->removeDockContainer(FloatingWidgets[FloatingWidgetIndex + i]->dockContainer());
+			break;
 		}
-    }
 
-    return Result;
+		MemoryUsage -= LeastRecentlyUsed->DecodedSize;
+		LeastRecentlyUsed->State = internal::DockingState();
+		LeastRecentlyUsed->Decoded = false;
+		LeastRecentlyUsed->DecodedSize = 0;
+	}
+}
+
+
+//============================================================================
+void DockManagerPrivate::deleteUnusedFloatingWidgets(int DockContainerCount)
+{
+	int FloatingWidgetIndex = DockContainerCount - 1;
+	int DeleteCount = FloatingWidgets.count() - FloatingWidgetIndex;
+	for (int i = 0; i < DeleteCount; ++i)
+	{
+		FloatingWidgets[FloatingWidgetIndex + i]->deleteLater();
+		_this->removeDockContainer(FloatingWidgets[FloatingWidgetIndex + i]->dockContainer());
+	}
+}
+
+
+//============================================================================
+void DockManagerPrivate::updateDockWidgetVisibility()
+{
+	if (ZOrderedContainersDirty)
+	{
+		updateZOrderedContainers();
+	}
+
+	// A container can only be covered by the containers in front of it, so
+	// all containers before the first changed entry keep their visibility
+	QVector<QPair<QRect, CDockContainerWidget*>> Containers;
+	Containers.reserve(ZOrderedContainers.count());
+	for (const auto& Entry : ZOrderedContainers)
+	{
+		Containers.append(qMakePair(Entry.second->window()->isMinimized()
+			? QRect() : Entry.first, Entry.second));
+	}
+
+	int Changed = 0;
+	while (Changed < Containers.count() && Changed < VisibilityContainers.count()
+		&& Containers[Changed] == VisibilityContainers[Changed])
+	{
+		++Changed;
+	}
+
+	for (int i = Changed; i < Containers.count(); ++i)
+	{
+		for (auto DockWidget : Containers[i].second->dockWidgets())
+		{
+			DockWidget->updateContentVisibility();
+		}
+	}
+	VisibilityContainers.swap(Containers);
+
+	auto DockWidgets = VisibilityUpdateWidgets;
+	VisibilityUpdateWidgets.clear();
+	for (auto DockWidget : DockWidgets)
+	{
+		if (DockWidget)
+		{
+			DockWidget->updateContentVisibility();
+		}
+	}
+}
+
+
+//============================================================================
+void DockManagerPrivate::registerDockWidget(CDockWidget* DockWidget)
+{
+	if (DockWidget->dockWidgetId() < 0)
+	{
+		DockWidget->setDockWidgetId(NextDockWidgetId++);
+	}
+
+	if (!DockWidgetsById.contains(DockWidget->dockWidgetId()))
+	{
+		DockWidgets.append(DockWidget);
+		DockWidgetsById.insert(DockWidget->dockWidgetId(), DockWidget);
+	}
+	DockWidgetsByName.insert(DockWidget->objectName(), DockWidget);
+}
+
+
+//============================================================================
+void DockManagerPrivate::unregisterDockWidget(CDockWidget* DockWidget)
+{
+	if (!DockWidgetsById.remove(DockWidget->dockWidgetId()))
+	{
+		return;
+	}
+
+	DockWidgets.removeOne(DockWidget);
+	if (DockWidgetsByName.value(DockWidget->objectName()) == DockWidget)
+	{
+		DockWidgetsByName.remove(DockWidget->objectName());
+	}
 }
 
 
@@ -259,7 +629,7 @@ void DockManagerPrivate::restoreDockWidgetsOpenState()
     // function are invisible to the user now and have no assigned dock area
     // They do not belong to any dock container, until the user toggles the
     // toggle view action the next time
-    for (auto DockWidget : DockWidgetsMap)
+    for (auto DockWidget : DockWidgets)
     {
     	if (DockWidget->property("dirty").toBool())
     	{
@@ -276,6 +646,7 @@ void DockManagerPrivate::restoreDockWidgetsOpenState()
 //============================================================================
 void DockManagerPrivate::restoreDockAreasIndices()
 {
+	ADS_INSTRUMENT_SCOPE(RestoreDockAreasIndices);
     // Now all dock areas are properly restored and we setup the index of
     // The dock areas because the previous toggleView() action has changed
     // the dock area index
@@ -312,9 +683,27 @@ void DockManagerPrivate::restoreDockAreasIndices()
 
 
 
+//============================================================================
+void DockManagerPrivate::createCurrentDockWidgetContents()
+{
+	for (auto DockContainer : Containers)
+	{
+		for (int i = 0; i < DockContainer->dockAreaCount(); ++i)
+		{
+			CDockWidget* DockWidget = DockContainer->dockArea(i)->currentDockWidget();
+			if (DockWidget && !DockWidget->isClosed())
+			{
+				DockWidget->createWidgetFromFactory();
+			}
+		}
+	}
+}
+
+
 //============================================================================
 void DockManagerPrivate::emitTopLevelEvents()
 {
+	ADS_INSTRUMENT_SCOPE(EmitTopLevelEvents);
     // Finally we need to send the topLevelChanged() signals for all dock
     // widgets if top level changed
     for (auto DockContainer : Containers)
@@ -340,30 +729,209 @@ void DockManagerPrivate::emitTopLevelEvents()
 
 
 //============================================================================
-bool DockManagerPrivate::restoreState(const QByteArray& State, int version)
+bool DockManagerPrivate::restoreState(const internal::DockingState& State,
+	int version)
 {
-	QByteArray state = State.startsWith("<?xml") ? State : qUncompress(State);
-    if (!checkFormat(state, version))
-    {
-    	qDebug() << "checkFormat: Error checking format!!!!!!!";
-    	return false;
-    }
+	if (!beginRestore(State, version))
+	{
+		return false;
+	}
 
-    // Hide updates of floating widgets from use
-    hideFloatingWidgets();
-    markDockWidgetsDirty();
+	createCurrentDockWidgetContents();
+	endRestore();
+	showRestoredState();
+	return true;
+}
 
-    if (!restoreStateFromXml(state, version))
-    {
-    	qDebug() << "restoreState: Error restoring state!!!!!!!";
-    	return false;
-    }
 
-    restoreDockWidgetsOpenState();
-    restoreDockAreasIndices();
-    emitTopLevelEvents();
+//============================================================================
+bool DockManagerPrivate::beginRestore(const internal::DockingState& State,
+	int version)
+{
+	// Prevent multiple calls as long as state is not restore. This may
+	// happen, if QApplication::processEvents() is called somewhere
+	if (RestoringState || AsyncDecoder)
+	{
+		return false;
+	}
+
+	if (State.Version != version)
+	{
+		ADS_PRINT("restoreState: Version mismatch" << State.Version << version);
+		return false;
+	}
+
+	// A new state replaces the contents that are still pending from a
+	// previous asynchronous restore
+	finishAsyncContents();
 
-    return true;
+	// We hide the complete dock manager here. Restoring the state means
+	// that DockWidgets are removed from the DockArea internal stack layout
+	// which in turn  means, that each time a widget is removed the stack
+	// will show and raise the next available widget which in turn
+	// triggers show events for the dock widgets. To avoid this we hide the
+	// dock manager. Because there will be no processing of application
+	// events until this function is finished, the user will not see this
+	// hiding.
+	// In incremental restore mode, most dock widgets stay in their dock
+	// areas. Hiding the dock manager would cause hide and show events for
+	// all of them, so we only disable the updates here
+	bool Incremental = ConfigFlags.testFlag(CDockManager::IncrementalStateRestore);
+	RestoreIncremental = Incremental;
+	RestoreWasHidden = _this->isHidden();
+	if (Incremental)
+	{
+		_this->setUpdatesEnabled(false);
+	}
+	else if (!RestoreWasHidden)
+	{
+		_this->hide();
+	}
+	RestoringState = true;
+	emit _this->restoringState();
+
+	// The state tree has been validated completely before, so applying it
+	// cannot fail anymore
+	if (!Incremental)
+	{
+		hideFloatingWidgets();
+	}
+	else
+	{
+		for (auto FloatingWidget : FloatingWidgets)
+		{
+			FloatingWidget->setUpdatesEnabled(false);
+		}
+	}
+	FloatingWidgetsShowDeferred = true;
+	markDockWidgetsDirty();
+	applyState(State);
+	restoreDockWidgetsOpenState();
+	restoreDockAreasIndices();
+	emitTopLevelEvents();
+	return true;
+}
+
+
+//============================================================================
+void DockManagerPrivate::showRestoredState()
+{
+	if (RestoreIncremental)
+	{
+		_this->setUpdatesEnabled(true);
+	}
+	else if (!RestoreWasHidden)
+	{
+		_this->show();
+	}
+
+	FloatingWidgetsShowDeferred = false;
+	showFloatingWidgets();
+}
+
+
+//============================================================================
+void DockManagerPrivate::endRestore()
+{
+	RestoringState = false;
+	emit _this->stateRestored();
+}
+
+
+//============================================================================
+QList<QPointer<CDockWidget>> DockManagerPrivate::pendingDockWidgetContents() const
+{
+	QList<QPointer<CDockWidget>> Result;
+	for (auto DockContainer : Containers)
+	{
+		for (int i = 0; i < DockContainer->dockAreaCount(); ++i)
+		{
+			CDockWidget* DockWidget = DockContainer->dockArea(i)->currentDockWidget();
+			if (DockWidget && !DockWidget->isClosed() && !DockWidget->isWidgetCreated())
+			{
+				Result.append(DockWidget);
+			}
+		}
+	}
+
+	return Result;
+}
+
+
+//============================================================================
+void DockManagerPrivate::asyncRestoreStep()
+{
+	// Decoding phase - the state is applied in one step as soon as the
+	// worker thread finished decoding
+	if (AsyncDecoder)
+	{
+		if (!AsyncDecoder->isFinished())
+		{
+			return;
+		}
+
+		auto Decoder = AsyncDecoder;
+		AsyncDecoder.reset();
+		if (!Decoder->isValid() || !beginRestore(Decoder->state(), AsyncVersion))
+		{
+			ADS_PRINT("restoreStateAsync: Error reading state");
+			AsyncRestoreTimer->stop();
+			emit _this->asyncRestoreFinished(false);
+			return;
+		}
+
+		showRestoredState();
+		AsyncPendingContents = pendingDockWidgetContents();
+		AsyncContentCount = AsyncPendingContents.count();
+		AsyncContentPhase = true;
+		// The layout is complete now. The dock manager is fully usable while
+		// the contents are created, so the restore ends here
+		endRestore();
+		emit _this->restoreProgress(0, AsyncContentCount);
+		AsyncRestoreTimer->setInterval(0);
+		return;
+	}
+
+	// Content creation phase - the dock widget contents are created in time
+	// slices, to keep the event loop responsive. Dock widgets that are shown
+	// in the meantime are moved to the front of the queue
+	QElapsedTimer SliceTimer;
+	SliceTimer.start();
+	while (!AsyncPendingContents.isEmpty() && SliceTimer.elapsed() < AsyncRestoreTimeSlice)
+	{
+		auto DockWidget = AsyncPendingContents.takeFirst();
+		if (DockWidget && !DockWidget->isClosed())
+		{
+			DockWidget->createWidgetFromFactory();
+		}
+		emit _this->restoreProgress(AsyncContentCount - AsyncPendingContents.count(),
+			AsyncContentCount);
+	}
+
+	if (!AsyncPendingContents.isEmpty())
+	{
+		return;
+	}
+
+	finishAsyncContents();
+}
+
+
+//============================================================================
+void DockManagerPrivate::finishAsyncContents()
+{
+	if (!AsyncContentPhase)
+	{
+		return;
+	}
+
+	AsyncContentPhase = false;
+	AsyncPendingContents.clear();
+	if (!AsyncDecoder)
+	{
+		AsyncRestoreTimer->stop();
+	}
+	emit _this->asyncRestoreFinished(true);
 }
 
 
@@ -407,148 +975,394 @@ CDockManager::CDockManager(QWidget *parent) :
 		MainWindow->setCentralWidget(this);
 	}
 
-	d->ViewMenu = new QMenu(tr("Show View"), this);
-	d->DockAreaOverlay = new CDockOverlay(this, CDockOverlay::ModeDockAreaOverlay);
-	d->ContainerOverlay = new CDockOverlay(this, CDockOverlay::ModeContainerOverlay);
-	d->Containers.append(this);
-	d->loadStylesheet();
+	d->ViewMenu = new QMenu(tr("Show View"), this);
+	d->DockAreaOverlay = new CDockOverlay(this, CDockOverlay::ModeDockAreaOverlay);
+	d->ContainerOverlay = new CDockOverlay(this, CDockOverlay::ModeContainerOverlay);
+	d->Containers.append(this);
+	d->loadStylesheet();
+
+	d->VisibilityUpdateTimer = new QTimer(this);
+	d->VisibilityUpdateTimer->setSingleShot(true);
+	d->VisibilityUpdateTimer->setInterval(0);
+	connect(d->VisibilityUpdateTimer, &QTimer::timeout, this, [this]()
+	{
+		d->updateDockWidgetVisibility();
+	});
+}
+
+//============================================================================
+CDockManager::~CDockManager()
+{
+	auto FloatingWidgets = d->FloatingWidgets;
+	for (auto FloatingWidget : FloatingWidgets)
+	{
+		delete FloatingWidget;
+	}
+
+	// The dock widgets of the main container are deleted after the private
+	// data, so they must not access the dock manager anymore
+	for (auto DockWidget : d->DockWidgets)
+	{
+		DockWidget->setDockManager(nullptr);
+	}
+	delete d;
+}
+
+
+//============================================================================
+void CDockManager::registerFloatingWidget(CFloatingDockContainer* FloatingWidget)
+{
+	d->FloatingWidgets.append(FloatingWidget);
+	ADS_PRINT("d->FloatingWidgets.count() " << d->FloatingWidgets.count());
+}
+
+
+//============================================================================
+void CDockManager::removeFloatingWidget(CFloatingDockContainer* FloatingWidget)
+{
+	d->FloatingWidgets.removeAll(FloatingWidget);
+}
+
+
+//============================================================================
+void CDockManager::registerDockContainer(CDockContainerWidget* DockContainer)
+{
+	d->Containers.append(DockContainer);
+	d->ZOrderedContainersDirty = true;
+}
+
+
+//============================================================================
+void CDockManager::removeDockContainer(CDockContainerWidget* DockContainer)
+{
+	if (this != DockContainer)
+	{
+		d->Containers.removeAll(DockContainer);
+		d->ZOrderedContainersDirty = true;
+	}
+}
+
+
+//============================================================================
+CDockContainerWidget* CDockManager::dockContainerAt(const QPoint& GlobalPos,
+	const CDockContainerWidget* Exclude) const
+{
+	if (d->ZOrderedContainersDirty)
+	{
+		d->updateZOrderedContainers();
+	}
+
+	for (const auto& Container : d->ZOrderedContainers)
+	{
+		if (Container.second != Exclude && Container.first.contains(GlobalPos))
+		{
+			return Container.second;
+		}
+	}
+
+	return nullptr;
+}
+
+
+//============================================================================
+void CDockManager::invalidateDockContainerOrder()
+{
+	d->ZOrderedContainersDirty = true;
+	scheduleDockWidgetVisibilityUpdate();
+}
+
+
+//============================================================================
+bool CDockManager::isCoveredByFloatingWidget(const QRect& GlobalRect,
+	const CDockContainerWidget* Container) const
+{
+	if (d->ZOrderedContainersDirty)
+	{
+		d->updateZOrderedContainers();
+	}
+
+	// The list is sorted from front to back, so we only need to check the
+	// containers before the given container
+	for (const auto& Entry : d->ZOrderedContainers)
+	{
+		if (Entry.second == Container)
+		{
+			break;
+		}
+
+		if (Entry.second->window()->isMinimized())
+		{
+			continue;
+		}
+
+		if (Entry.first.contains(GlobalRect))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//============================================================================
+void CDockManager::scheduleDockWidgetVisibilityUpdate(CDockWidget* DockWidget)
+{
+	if (DockWidget && !d->VisibilityUpdateWidgets.contains(DockWidget))
+	{
+		d->VisibilityUpdateWidgets.append(DockWidget);
+	}
+
+	// The timer does not exist yet, if dock containers are created in the
+	// constructor
+	if (d->VisibilityUpdateTimer && !d->VisibilityUpdateTimer->isActive())
+	{
+		d->VisibilityUpdateTimer->start();
+	}
+}
+
+
+//============================================================================
+bool CDockManager::isFloatingWidgetShowDeferred() const
+{
+	return d->FloatingWidgetsShowDeferred;
+}
+
+
+//============================================================================
+CDockOverlay* CDockManager::containerOverlay() const
+{
+	return d->ContainerOverlay;
+}
+
+
+//============================================================================
+CDockOverlay* CDockManager::dockAreaOverlay() const
+{
+	return d->DockAreaOverlay;
+}
+
+
+//============================================================================
+const QList<CDockContainerWidget*> CDockManager::dockContainers() const
+{
+	return d->Containers;
+}
+
+
+//============================================================================
+const QList<CFloatingDockContainer*> CDockManager::floatingWidgets() const
+{
+	return d->FloatingWidgets;
+}
+
+
+//============================================================================
+unsigned int CDockManager::zOrderIndex() const
+{
+	return 0;
+}
+
+
+//============================================================================
+QByteArray CDockManager::saveState(int version) const
+{
+	QByteArray Result;
+	QBuffer Buffer(&Result);
+	Buffer.open(QIODevice::WriteOnly);
+	saveState(&Buffer, version);
+	return Result;
+}
+
+
+//============================================================================
+bool CDockManager::saveState(QIODevice* Device, int version) const
+{
+	if (!Device || !Device->isWritable())
+	{
+		return false;
+	}
+
+	if (d->ConfigFlags.testFlag(BinaryStateFormat))
+	{
+		// The payload needs to be buffered because the checksum and the
+		// size are written with the payload
+		QByteArray Payload;
+		QDataStream PayloadStream(&Payload, QIODevice::WriteOnly);
+		PayloadStream.setVersion(QDataStream::Qt_5_5);
+		PayloadStream << qint32(d->Containers.count());
+		for (auto Container : d->Containers)
+		{
+			Container->saveState(PayloadStream);
+		}
+
+		QDataStream s(Device);
+		s.setVersion(QDataStream::Qt_5_5);
+		s << internal::BinaryStateMagic << internal::BinaryStateFormatVersion
+		  << qint32(version) << Payload
+		  << quint16(qChecksum(Payload.constData(), Payload.size()));
+		return s.status() == QDataStream::Ok;
+	}
+
+	if (!d->ConfigFlags.testFlag(XmlCompressionEnabled))
+	{
+		return d->writeXmlState(Device, version);
+	}
+
+	// qCompress() needs the complete input, so compressed XML is buffered
+	QByteArray xmldata;
+	QBuffer Buffer(&xmldata);
+	Buffer.open(QIODevice::WriteOnly);
+	if (!d->writeXmlState(&Buffer, version))
+	{
+		return false;
+	}
+	Buffer.close();
+	QByteArray Compressed = qCompress(xmldata, 9);
+	return Device->write(Compressed) == Compressed.size();
 }
 
+
 //============================================================================
-CDockManager::~CDockManager()
+bool CDockManager::restoreState(const QByteArray &state, int version)
 {
-	auto FloatingWidgets = d->FloatingWidgets;
-	for (auto FloatingWidget : FloatingWidgets)
+	if (d->RestoringState)
 	{
-		delete FloatingWidget;
+		return false;
 	}
-	delete d;
+
+	// The state is decoded and validated in a single pass before any dock
+	// widget is touched
+	internal::DockingState State;
+	if (!internal::readDockingState(state, State))
+	{
+		ADS_PRINT("restoreState: Error reading state!!!!!!!");
+		return false;
+	}
+
+	return d->restoreState(State, version);
 }
 
 
 //============================================================================
-void CDockManager::registerFloatingWidget(CFloatingDockContainer* FloatingWidget)
+bool CDockManager::restoreState(QIODevice* Device, int version)
 {
-	d->FloatingWidgets.append(FloatingWidget);
-	qDebug() << "d->FloatingWidgets.count() " << d->FloatingWidgets.count();
+	if (d->RestoringState)
+	{
+		return false;
+	}
+
+	internal::DockingState State;
+	if (!internal::readDockingState(Device, State))
+	{
+		ADS_PRINT("restoreState: Error reading state from device");
+		return false;
+	}
+
+	return d->restoreState(State, version);
 }
 
 
 //============================================================================
-void CDockManager::removeFloatingWidget(CFloatingDockContainer* FloatingWidget)
+bool CDockStateHandle::isNull() const
 {
-	d->FloatingWidgets.removeAll(FloatingWidget);
+	return d.isNull();
 }
 
 
 //============================================================================
-void CDockManager::registerDockContainer(CDockContainerWidget* DockContainer)
+bool CDockStateHandle::isFinished() const
 {
-	d->Containers.append(DockContainer);
+	return d && d->isFinished();
 }
 
 
 //============================================================================
-void CDockManager::removeDockContainer(CDockContainerWidget* DockContainer)
+void CDockStateHandle::waitForFinished() const
 {
-	if (this != DockContainer)
+	if (d)
 	{
-		d->Containers.removeAll(DockContainer);
+		d->waitForFinished();
 	}
 }
 
 
 //============================================================================
-CDockOverlay* CDockManager::containerOverlay() const
+bool CDockStateHandle::isValid() const
 {
-	return d->ContainerOverlay;
+	return d && d->isValid();
 }
 
 
 //============================================================================
-CDockOverlay* CDockManager::dockAreaOverlay() const
+CDockStateHandle CDockManager::decodeState(const QByteArray &state)
 {
-	return d->DockAreaOverlay;
+	CDockStateHandle Handle;
+	Handle.d = internal::DockingStateDecoder::start(state);
+	return Handle;
 }
 
 
 //============================================================================
-const QList<CDockContainerWidget*> CDockManager::dockContainers() const
+CDockStateHandle CDockManager::decodeStateFile(const QString& FileName)
 {
-	return d->Containers;
+	CDockStateHandle Handle;
+	Handle.d = internal::DockingStateDecoder::startFile(FileName);
+	return Handle;
 }
 
 
 //============================================================================
-const QList<CFloatingDockContainer*> CDockManager::floatingWidgets() const
+bool CDockManager::restoreState(const CDockStateHandle& State, int version)
 {
-	return d->FloatingWidgets;
-}
+	if (d->RestoringState)
+	{
+		return false;
+	}
 
+	if (!State.isValid())
+	{
+		ADS_PRINT("restoreState: Error reading state");
+		return false;
+	}
 
-//============================================================================
-unsigned int CDockManager::zOrderIndex() const
-{
-	return 0;
+	return d->restoreState(State.d->state(), version);
 }
 
 
 //============================================================================
-QByteArray CDockManager::saveState(int version) const
+bool CDockManager::restoreStateAsync(const QByteArray &state, int version)
 {
-    QByteArray xmldata;
-    QXmlStreamWriter s(&xmldata);
-	s.setAutoFormatting(d->ConfigFlags.testFlag(XmlAutoFormattingEnabled));
-    s.writeStartDocument();
-		s.writeStartElement("QtAdvancedDockingSystem");
-		s.writeAttribute("Version", QString::number(version));
-		s.writeAttribute("Containers", QString::number(d->Containers.count()));
-		for (auto Container : d->Containers)
-		{
-			Container->saveState(s);
-		}
-
-		s.writeEndElement();
-    s.writeEndDocument();
+	if (d->RestoringState || d->AsyncDecoder)
+	{
+		return false;
+	}
 
-    return d->ConfigFlags.testFlag(XmlCompressionEnabled) ? qCompress(xmldata, 9) : xmldata;
+	return restoreStateAsync(decodeState(state), version);
 }
 
 
 //============================================================================
-bool CDockManager::restoreState(const QByteArray &state, int version)
+bool CDockManager::restoreStateAsync(const CDockStateHandle& State, int version)
 {
-	// Prevent multiple calls as long as state is not restore. This may
-	// happen, if QApplication::processEvents() is called somewhere
-	if (d->RestoringState)
+	if (d->RestoringState || d->AsyncDecoder || State.isNull())
 	{
 		return false;
 	}
 
-	// We hide the complete dock manager here. Restoring the state means
-	// that DockWidgets are removed from the DockArea internal stack layout
-	// which in turn  means, that each time a widget is removed the stack
-	// will show and raise the next available widget which in turn
-	// triggers show events for the dock widgets. To avoid this we hide the
-	// dock manager. Because there will be no processing of application
-	// events until this function is finished, the user will not see this
-	// hiding
-	bool IsHidden = this->isHidden();
-	if (!IsHidden)
+	if (!d->AsyncRestoreTimer)
 	{
-		hide();
-	}
-	d->RestoringState = true;
-	emit restoringState();
-	bool Result = d->restoreState(state, version);
-	d->RestoringState = false;
-	emit stateRestored();
-	if (!IsHidden)
-	{
-		show();
+		d->AsyncRestoreTimer = new QTimer(this);
+		connect(d->AsyncRestoreTimer, &QTimer::timeout, this,
+			[this]() { d->asyncRestoreStep(); });
 	}
 
-	return Result;
+	d->finishAsyncContents();
+	d->AsyncVersion = version;
+	d->AsyncDecoder = State.d;
+	d->AsyncRestoreTimer->setInterval(AsyncDecodePollInterval);
+	d->AsyncRestoreTimer->start();
+	return true;
 }
 
 
@@ -556,7 +1370,7 @@ bool CDockManager::restoreState(const QByteArray &state, int version)
 CDockAreaWidget* CDockManager::addDockWidget(DockWidgetArea area,
 	CDockWidget* Dockwidget, CDockAreaWidget* DockAreaWidget)
 {
-	d->DockWidgetsMap.insert(Dockwidget->objectName(), Dockwidget);
+	d->registerDockWidget(Dockwidget);
 	return CDockContainerWidget::addDockWidget(area, Dockwidget, DockAreaWidget);
 }
 
@@ -592,28 +1406,70 @@ CDockAreaWidget* CDockManager::addDockWidgetTabToArea(CDockWidget* Dockwidget,
 //============================================================================
 CDockWidget* CDockManager::findDockWidget(const QString& ObjectName) const
 {
-	return d->DockWidgetsMap.value(ObjectName, nullptr);
+	return d->DockWidgetsByName.value(ObjectName, nullptr);
+}
+
+
+//============================================================================
+CDockWidget* CDockManager::findDockWidget(const QStringRef& ObjectName) const
+{
+	// The raw data string refers to the characters of the string reference,
+	// so the lookup does not copy the name
+	return d->DockWidgetsByName.value(QString::fromRawData(ObjectName.unicode(),
+		ObjectName.size()), nullptr);
+}
+
+
+//============================================================================
+CDockWidget* CDockManager::findDockWidget(int Id) const
+{
+	return d->DockWidgetsById.value(Id, nullptr);
 }
 
 //============================================================================
 void CDockManager::removeDockWidget(CDockWidget* Dockwidget)
 {
-	d->DockWidgetsMap.remove(Dockwidget->objectName());
+	d->unregisterDockWidget(Dockwidget);
 	CDockContainerWidget::removeDockWidget(Dockwidget);
 }
 
+
+//============================================================================
+void CDockManager::unregisterDockWidget(CDockWidget* DockWidget)
+{
+	d->unregisterDockWidget(DockWidget);
+}
+
 //============================================================================
 QMap<QString, CDockWidget*> CDockManager::dockWidgetsMap() const
 {
-	return d->DockWidgetsMap;
+	QMap<QString, CDockWidget*> Map;
+	for (auto it = d->DockWidgetsByName.constBegin(); it != d->DockWidgetsByName.constEnd(); ++it)
+	{
+		Map.insert(it.key(), it.value());
+	}
+	return Map;
+}
+
+
+//============================================================================
+const QVector<CDockWidget*>& CDockManager::dockWidgets() const
+{
+	return d->DockWidgets;
 }
 
 
 //============================================================================
-void CDockManager::addPerspective(const QString& UniquePrespectiveName)
+bool CDockManager::addPerspective(const QString& UniquePrespectiveName)
 {
-	d->Perspectives.insert(UniquePrespectiveName, saveState());
+	if (!d->insertPerspective(UniquePrespectiveName, saveState()))
+	{
+		qWarning() << Q_FUNC_INFO << "Failed to store perspective" << UniquePrespectiveName;
+		return false;
+	}
+
 	emit perspectiveListChanged();
+	return true;
 }
 
 
@@ -651,14 +1507,27 @@ QStringList CDockManager::perspectiveNames() const
 //============================================================================
 void CDockManager::openPerspective(const QString& PerspectiveName)
 {
-	const auto Iterator = d->Perspectives.find(PerspectiveName);
+	auto Iterator = d->Perspectives.find(PerspectiveName);
 	if (d->Perspectives.end() == Iterator)
 	{
 		return;
 	}
 
+	// The decoded state is normally available here. It only needs to be
+	// decoded again, if it has been released because of the cache limit
+	if (!d->decodePerspective(Iterator.value()))
+	{
+		ADS_PRINT("openPerspective: Invalid perspective " << PerspectiveName);
+		return;
+	}
+	Iterator->LastUsed = ++d->PerspectiveUseCounter;
+	d->trimPerspectiveCache(PerspectiveName);
+
+	// We work on a copy here because the perspective might get removed
+	// by a slot that is connected to one of the emitted signals
+	const internal::DockingState State = Iterator->State;
 	emit openingPerspective(PerspectiveName);
-	restoreState(Iterator.value());
+	d->restoreState(State, 0);
 	emit perspectiveOpened(PerspectiveName);
 }
 
@@ -672,7 +1541,7 @@ void CDockManager::savePerspectives(QSettings& Settings) const
 	{
 		Settings.setArrayIndex(i);
 		Settings.setValue("Name", it.key());
-		Settings.setValue("State", it.value());
+		Settings.setValue("State", d->perspectiveData(it.value()));
 		++i;
 	}
 	Settings.endArray();
@@ -700,12 +1569,96 @@ void CDockManager::loadPerspectives(QSettings& Settings)
 			continue;
 		}
 
-		d->Perspectives.insert(Name, Data);
+		if (!d->insertPerspective(Name, Data))
+		{
+			ADS_PRINT("loadPerspectives: Skipping invalid perspective " << Name);
+		}
 	}
 
 	Settings.endArray();
 }
 
+
+//============================================================================
+static QString perspectiveFileName(const QDir& Dir, const QString& Name)
+{
+	return Dir.filePath(QString::fromLatin1(QUrl::toPercentEncoding(Name))
+		+ QStringLiteral(".perspective"));
+}
+
+
+//============================================================================
+bool CDockManager::savePerspectives(const QString& DirName) const
+{
+	QDir Dir(DirName);
+	if (!Dir.mkpath(QStringLiteral(".")))
+	{
+		return false;
+	}
+
+	bool Result = true;
+	QSet<QString> FileNames;
+	for (auto it = d->Perspectives.constBegin(); it != d->Perspectives.constEnd(); ++it)
+	{
+		QString FileName = perspectiveFileName(Dir, it.key());
+		FileNames.insert(QFileInfo(FileName).fileName());
+		// A perspective that has been loaded from this file on demand is
+		// still unchanged
+		if (it->Data.isEmpty() && QFileInfo(it->FileName) == QFileInfo(FileName))
+		{
+			continue;
+		}
+
+		// A failed write must not leave a truncated perspective file that
+		// loadPerspectives() would pick up later
+		QByteArray Data = d->perspectiveData(it.value());
+		QSaveFile File(FileName);
+		if (!File.open(QIODevice::WriteOnly) || File.write(Data) != Data.size()
+		 || !File.commit())
+		{
+			ADS_PRINT("savePerspectives: Cannot write " << FileName);
+			Result = false;
+		}
+	}
+
+	// Files of removed perspectives would be loaded again by
+	// loadPerspectives(), so they are deleted
+	const auto Files = Dir.entryList({QStringLiteral("*.perspective")}, QDir::Files);
+	for (const auto& FileName : Files)
+	{
+		if (!FileNames.contains(FileName) && !Dir.remove(FileName))
+		{
+			ADS_PRINT("savePerspectives: Cannot remove " << FileName);
+			Result = false;
+		}
+	}
+
+	return Result;
+}
+
+
+//============================================================================
+void CDockManager::loadPerspectives(const QString& DirName)
+{
+	d->Perspectives.clear();
+	QDir Dir(DirName);
+	const auto Files = Dir.entryInfoList({QStringLiteral("*.perspective")}, QDir::Files);
+	for (const auto& FileInfo : Files)
+	{
+		QString Name = QUrl::fromPercentEncoding(FileInfo.completeBaseName().toLatin1());
+		if (Name.isEmpty())
+		{
+			continue;
+		}
+
+		// The file is only read and decoded, if the perspective is opened
+		PerspectiveEntry Entry;
+		Entry.FileName = FileInfo.absoluteFilePath();
+		Entry.LastUsed = ++d->PerspectiveUseCounter;
+		d->Perspectives.insert(Name, Entry);
+	}
+}
+
 //============================================================================
 QAction* CDockManager::addToggleViewActionToMenu(QAction* ToggleViewAction,
 	const QString& Group, const QIcon& GroupIcon)
@@ -754,6 +1707,64 @@ bool CDockManager::isRestoringState() const
 }
 
 
+//============================================================================
+bool CDockManager::prioritizeWidgetContent(CDockWidget* DockWidget)
+{
+	if (!d->AsyncContentPhase)
+	{
+		return false;
+	}
+
+	if (!d->AsyncPendingContents.removeAll(DockWidget))
+	{
+		++d->AsyncContentCount;
+	}
+	d->AsyncPendingContents.prepend(DockWidget);
+	return true;
+}
+
+
+//============================================================================
+void CDockManager::beginUpdate()
+{
+	if (0 == d->UpdateDepth++)
+	{
+		d->UpdatesEnabledBeforeUpdate = updatesEnabled();
+		setUpdatesEnabled(false);
+	}
+}
+
+
+//============================================================================
+void CDockManager::endUpdate()
+{
+	if (d->UpdateDepth <= 0)
+	{
+		qWarning() << Q_FUNC_INFO << "endUpdate() without beginUpdate()";
+		return;
+	}
+
+	if (--d->UpdateDepth)
+	{
+		return;
+	}
+
+	for (auto DockContainer : d->Containers)
+	{
+		DockContainer->flushDeferredUpdates();
+	}
+	d->emitTopLevelEvents();
+	setUpdatesEnabled(d->UpdatesEnabledBeforeUpdate);
+}
+
+
+//============================================================================
+bool CDockManager::isUpdating() const
+{
+	return d->UpdateDepth > 0;
+}
+
+
 //===========================================================================
 int CDockManager::startDragDistance()
 {
@@ -761,6 +1772,51 @@ int CDockManager::startDragDistance()
 }
 
 
+//===========================================================================
+QString CDockManager::defaultStyleSheet()
+{
+	static const QString StyleSheet = []()
+	{
+#ifdef Q_OS_LINUX
+		QFile StyleSheetFile(":ads/stylesheets/default_linux.css");
+#else
+		QFile StyleSheetFile(":ads/stylesheets/default.css");
+#endif
+		StyleSheetFile.open(QIODevice::ReadOnly);
+		return QString::fromUtf8(StyleSheetFile.readAll());
+	}();
+	return StyleSheet;
+}
+
+
+//===========================================================================
+void CDockManager::setStyleSheetMode(eStyleSheetMode Mode)
+{
+	StyleSheetMode = Mode;
+}
+
+
+//===========================================================================
+CDockManager::eStyleSheetMode CDockManager::styleSheetMode()
+{
+	return StyleSheetMode;
+}
+
+
+//===========================================================================
+void CDockManager::setInstrumentation(CDockInstrumentation* Instrumentation)
+{
+	CDockInstrumentation::setInstance(Instrumentation);
+}
+
+
+//===========================================================================
+CDockInstrumentation* CDockManager::instrumentation()
+{
+	return CDockInstrumentation::instance();
+}
+
+
 //===========================================================================
 CDockManager::ConfigFlags CDockManager::configFlags() const
 {
@@ -775,6 +1831,47 @@ void CDockManager::setConfigFlags(const ConfigFlags Flags)
 }
 
 
+//===========================================================================
+int CDockManager::maxDragUpdateRate() const
+{
+	return d->MaxDragUpdateRate;
+}
+
+
+//===========================================================================
+void CDockManager::setMaxDragUpdateRate(int UpdatesPerSecond)
+{
+	d->MaxDragUpdateRate = qMax(0, UpdatesPerSecond);
+}
+
+
+//===========================================================================
+qint64 CDockManager::perspectivesMemoryUsage() const
+{
+	qint64 Result = 0;
+	for (const auto& Entry : d->Perspectives)
+	{
+		Result += Entry.Data.capacity() + Entry.DecodedSize;
+	}
+	return Result;
+}
+
+
+//===========================================================================
+qint64 CDockManager::perspectiveCacheLimit() const
+{
+	return d->PerspectiveCacheLimit;
+}
+
+
+//===========================================================================
+void CDockManager::setPerspectiveCacheLimit(qint64 Bytes)
+{
+	d->PerspectiveCacheLimit = qMax(Q_INT64_C(0), Bytes);
+	d->trimPerspectiveCache();
+}
+
+
 } // namespace ads
 
 //---------------------------------------------------------------------------
@@ -32,10 +32,13 @@
 //============================================================================
 #include "DockContainerWidget.h"
 #include <QIcon>
+#include <QSharedPointer>
+#include <QVector>
 
 #include "ads_globals.h"
 
 class QSettings;
+class QIODevice;
 class QMenu;
 
 namespace ads
@@ -45,10 +48,55 @@ class CFloatingDockContainer;
 struct FloatingDockContainerPrivate;
 class CDockContainerWidget;
 class CDockOverlay;
+class CDockInstrumentation;
 class CDockAreaTabBar;
 class CDockWidgetTab;
 struct DockWidgetTabPrivate;
 struct DockAreaWidgetPrivate;
+namespace internal {class DockingStateDecoder;}
+
+/**
+ * Handle to a saved state that is decoded in a worker thread.
+ * A handle is returned by CDockManager::decodeState() and
+ * CDockManager::decodeStateFile(). It can be passed to
+ * CDockManager::restoreState() or CDockManager::restoreStateAsync() later.
+ * This way an application can start decoding its saved layout early in
+ * main() and construct its dock widgets in the meantime.
+ * Handles are cheap to copy - all copies refer to the same decoded state.
+ */
+class ADS_EXPORT CDockStateHandle
+{
+private:
+	QSharedPointer<internal::DockingStateDecoder> d;
+	friend class CDockManager;
+
+public:
+	/**
+	 * Creates a null handle
+	 */
+	CDockStateHandle() = default;
+
+	/**
+	 * Returns true, if this handle does not refer to a state
+	 */
+	bool isNull() const;
+
+	/**
+	 * Returns true, if decoding of the state has finished
+	 */
+	bool isFinished() const;
+
+	/**
+	 * Blocks until decoding of the state has finished
+	 */
+	void waitForFinished() const;
+
+	/**
+	 * Waits until decoding has finished and returns true, if the state is a
+	 * valid docking system state
+	 */
+	bool isValid() const;
+};
 
 /**
  * The central dock manager that maintains the complete docking system.
@@ -68,6 +116,9 @@ private:
 	friend class CDockWidgetTab;
 	friend struct DockAreaWidgetPrivate;
 	friend struct DockWidgetTabPrivate;
+	friend class CDockWidget;
+	friend class CFloatingDragPreview;
+	friend struct FloatingDragPreviewPrivate;
 
 protected:
 	/**
@@ -93,6 +144,66 @@ protected:
 	 */
 	void removeDockContainer(CDockContainerWidget* DockContainer);
 
+	/**
+	 * Returns the visible dock container at the given global position, that
+	 * is in front of all other containers at this position. The container
+	 * given in Exclude is ignored.
+	 * The function uses a cached list of the container geometries that is
+	 * sorted by z order index from front to back.
+	 */
+	CDockContainerWidget* dockContainerAt(const QPoint& GlobalPos,
+		const CDockContainerWidget* Exclude = nullptr) const;
+
+	/**
+	 * Marks the cached z order and geometry of the dock containers as
+	 * outdated. Dock containers call this on activation, show, hide, move
+	 * and resize events.
+	 * Because this may change the visibility of dock widgets that are
+	 * covered by floating widgets, this function also schedules an update
+	 * of the dock widget visibility
+	 */
+	void invalidateDockContainerOrder();
+
+	/**
+	 * Returns true, if the given global rectangle of a dock widget in the
+	 * given container is completely covered by a visible floating widget
+	 * that is in front of the container
+	 */
+	bool isCoveredByFloatingWidget(const QRect& GlobalRect,
+		const CDockContainerWidget* Container) const;
+
+	/**
+	 * Schedules an update of the content visibility of the dock widgets.
+	 * The update is done in the next event loop cycle, so multiple calls are
+	 * merged into a single update. Only the dock widgets of containers that
+	 * may be covered differently than in the last update are updated. If
+	 * DockWidget is given, this dock widget is updated in any case.
+	 * \see CDockWidget::isContentVisible()
+	 */
+	void scheduleDockWidgetVisibilityUpdate(CDockWidget* DockWidget = nullptr);
+
+	/**
+	 * Removes the given dock widget from the dock widget registry without
+	 * removing it from its dock area. Dock widgets call this when they are
+	 * deleted
+	 */
+	void unregisterDockWidget(CDockWidget* DockWidget);
+
+	/**
+	 * Returns true, while a state is restored and the floating widgets
+	 * defer all show and hide requests until the restored state is shown
+	 */
+	bool isFloatingWidgetShowDeferred() const;
+
+	/**
+	 * Moves the given dock widget to the front of the contents that are
+	 * created by a running asynchronous restore. Dock widgets call this if
+	 * they are shown before their content has been created.
+	 * Returns false, if no asynchronous restore is creating contents - the
+	 * dock widget needs to create its content itself in this case
+	 */
+	bool prioritizeWidgetContent(CDockWidget* DockWidget);
+
 	/**
 	 * Overlay for containers
 	 */
@@ -122,10 +233,28 @@ public:
 		OpaqueSplitterResize = 0x08, //!< See QSplitter::setOpaqueResize() documentation
 		XmlAutoFormattingEnabled = 0x10,//!< If enabled, the XML writer automatically adds line-breaks and indentation to empty sections between elements (ignorable whitespace).
 		XmlCompressionEnabled = 0x20,//!< If enabled, the XML output will be compressed and is not human readable anymore
+		BinaryStateFormat = 0x40,//!< If enabled, saveState() writes a compact, checksum protected binary format instead of XML. restoreState() detects the format automatically
+		IncrementalStateRestore = 0x80,//!< If enabled, restoreState() and openPerspective() keep unchanged layouts and reuse existing dock areas instead of rebuilding all dock areas and splitters
+		KeepTabContentParented = 0x100,//!< If enabled, the dock widgets in inactive tabs stay parented to their dock area, so switching tabs does not reparent native or OpenGL content widgets
+		VirtualizedTabBar = 0x200,//!< If enabled, dock area tab bars only realize the tabs in the visible viewport plus a margin. All other tabs are replaced by placeholders in the tab layout
+		LightweightDropOverlay = 0x400,//!< If enabled, the drop overlays do not show translucent top level windows over the drop targets. The drop preview is shown by a native QRubberBand instead, which is much cheaper on systems without compositing or over remote desktop connections
+		GhostDragPreview = 0x800,//!< If enabled, dragging a tab or a dock area title bar only moves a lightweight preview window. The real floating widget is created, when the dragged content is released outside of any drop area, or is never created, if it is dropped into a dock container
+		AdaptiveSplitterResize = 0x1000,//!< If enabled, each splitter uses opaque resizing as long as a single splitter move stays within the opaque resize budget and switches to non opaque resizing, if its content is too expensive to relayout. Overrides OpaqueSplitterResize. See CDockSplitter::setAdaptiveOpaqueResize()
 		DefaultConfig = ActiveTabHasCloseButton | DockAreaHasCloseButton | OpaqueSplitterResize | XmlCompressionEnabled, ///< the default configuration
 	};
 	Q_DECLARE_FLAGS(ConfigFlags, eConfigFlag)
 
+	/**
+	 * Controls, how the default stylesheet is applied by new dock managers
+	 * \see setStyleSheetMode()
+	 */
+	enum eStyleSheetMode
+	{
+		WidgetStyleSheet,     //!< each dock manager applies the default stylesheet to itself (default)
+		ApplicationStyleSheet,//!< the default stylesheet is appended once to the application stylesheet and is shared by all dock managers
+		NoStyleSheet          //!< no stylesheet is applied - use this, if the application provides a QStyle, QProxyStyle or palette based theme
+	};
+
 	/**
 	 * Default Constructor.
 	 * If the given parent is a QMainWindow, the dock manager sets itself as the
@@ -151,6 +280,22 @@ public:
 	 */
 	void setConfigFlags(const ConfigFlags Flags);
 
+	/**
+	 * Returns the maximum number of floating widget moves and drop overlay
+	 * updates per second while a floating widget is dragged.
+	 * A value of 0 means that every mouse move is processed immediately.
+	 */
+	int maxDragUpdateRate() const;
+
+	/**
+	 * Sets the maximum number of floating widget moves and drop overlay
+	 * updates per second while a floating widget is dragged. Mouse moves
+	 * that arrive faster are merged into one update with the latest cursor
+	 * position. The default value of 60 allows one update per display frame.
+	 * Set this to 0 to disable the throttling.
+	 */
+	void setMaxDragUpdateRate(int UpdatesPerSecond);
+
 	/**
 	 * Adds dockwidget into the given area.
 	 * If DockAreaWidget is not null, then the area parameter indicates the area
@@ -190,17 +335,38 @@ public:
 	 */
 	CDockWidget* findDockWidget(const QString& ObjectName) const;
 
+	/**
+	 * Overloaded function that searches for a registered dock widget with
+	 * the given ObjectName without copying the name
+	 */
+	CDockWidget* findDockWidget(const QStringRef& ObjectName) const;
+
+	/**
+	 * Searches for the registered dock widget with the given numeric id
+	 * \see CDockWidget::dockWidgetId()
+	 */
+	CDockWidget* findDockWidget(int Id) const;
+
 	/**
 	 * Remove the given Dock from the dock manager
 	 */
 	void removeDockWidget(CDockWidget* Dockwidget);
 
 	/**
-	 * This function returns a readable reference to the internal dock
-	 * widgets map so that it is possible to iterate over all dock widgets
+	 * This function returns a map of all registered dock widgets sorted by
+	 * their object names.
+	 * The map is built on each call. Use dockWidgets() to iterate over all
+	 * dock widgets without building a map.
 	 */
 	QMap<QString, CDockWidget*> dockWidgetsMap() const;
 
+	/**
+	 * Returns all registered dock widgets in the order they have been added
+	 * to the dock manager. The returned reference is invalidated if dock
+	 * widgets are added or removed
+	 */
+	const QVector<CDockWidget*>& dockWidgets() const;
+
 	/**
 	 * Returns the list of all active and visible dock containers
 	 * Dock containers are the main dock manager and all floating widgets
@@ -225,9 +391,21 @@ public:
 	 * If auto formatting is enabled, the output is intended and line wrapped.
 	 * The XmlMode XmlAutoFormattingDisabled is better if you would like to have
 	 * a more compact XML output - i.e. for storage in ini files.
+	 * If the BinaryStateFormat config flag is set, the state is written in a
+	 * compact binary format instead of XML.
 	 */
 	QByteArray saveState(int version = 0) const;
 
+	/**
+	 * Writes the current state directly to the given device, i.e. to a
+	 * file. Uncompressed XML is streamed to the device without an
+	 * intermediate buffer. Compressed XML and the binary format need to be
+	 * assembled in memory before they are written.
+	 * Returns false, if the device is not writable or the state could not
+	 * be written completely.
+	 */
+	bool saveState(QIODevice* Device, int version = 0) const;
+
 	/**
 	 * Restores the state of this dockmanagers dockwidgets.
 	 * The version number is compared with that stored in state. If they do
@@ -237,6 +415,58 @@ public:
 	 */
 	bool restoreState(const QByteArray &state, int version = 0);
 
+	/**
+	 * Restores the state from the current position of the given device.
+	 * Files are mapped into memory instead of being read into a buffer and
+	 * plain XML is parsed directly from the device.
+	 * \see restoreState(const QByteArray&, int)
+	 */
+	bool restoreState(QIODevice* Device, int version = 0);
+
+	/**
+	 * Restores the state asynchronously without blocking the event loop.
+	 * The state is decoded and validated in a worker thread. Then the
+	 * layout is applied in one step and the contents of the dock widgets
+	 * that are created via widget factories are created in time sliced
+	 * chunks. The function emits restoringState() and stateRestored() like
+	 * restoreState(), as soon as the layout has been applied. The dock
+	 * manager is fully usable while the contents are created. Dock widgets
+	 * that are shown in this phase get their contents first.
+	 * restoreProgress() reports the created contents and
+	 * asyncRestoreFinished() is emitted at the end. Starting another
+	 * restore ends the content creation of the running one.
+	 * Returns false, if a restore is already running.
+	 */
+	bool restoreStateAsync(const QByteArray &state, int version = 0);
+
+	/**
+	 * Starts decoding of the given saved state in a worker thread and
+	 * returns a handle to the decoded state.
+	 * This function does not need a dock manager instance, so it can be
+	 * called before the dock manager and the dock widgets are created.
+	 */
+	static CDockStateHandle decodeState(const QByteArray &state);
+
+	/**
+	 * Starts reading and decoding of the saved state in the given file in a
+	 * worker thread and returns a handle to the decoded state.
+	 */
+	static CDockStateHandle decodeStateFile(const QString& FileName);
+
+	/**
+	 * Restores the state from a handle returned by decodeState().
+	 * If decoding has not finished yet, the function blocks until the
+	 * worker thread has finished.
+	 */
+	bool restoreState(const CDockStateHandle& State, int version = 0);
+
+	/**
+	 * Restores the state from a handle returned by decodeState()
+	 * asynchronously.
+	 * \see restoreStateAsync(const QByteArray&, int)
+	 */
+	bool restoreStateAsync(const CDockStateHandle& State, int version = 0);
+
 	/**
 	 * Saves the current perspective to the internal list of perspectives.
 	 * A perspective is the current state of the dock manager assigned
@@ -244,8 +474,11 @@ public:
 	 * to switch between different perspectives quickly.
 	 * If a perspective with the given name already exists, then
 	 * it will be overwritten with the new state.
+	 * Returns false, if the current state could not be stored. The list of
+	 * perspectives is unchanged and perspectiveListChanged() is not emitted
+	 * in this case.
 	 */
-	void addPerspective(const QString& UniquePrespectiveName);
+	bool addPerspective(const QString& UniquePrespectiveName);
 
 	/**
 	 * Removes the perspective with the given name from the list of perspectives
@@ -268,10 +501,60 @@ public:
 	void savePerspectives(QSettings& Settings) const;
 
 	/**
-	 * Loads the perspectives from the given settings file
+	 * Loads the perspectives from the given settings file.
+	 * The perspectives are decoded and validated while loading, so that
+	 * openPerspective() does not need to parse them again. Invalid
+	 * perspectives are skipped.
 	 */
 	void loadPerspectives(QSettings& Settings);
 
+	/**
+	 * Saves each perspective into its own file in the given directory. The
+	 * directory is created, if it does not exist. Perspectives that have
+	 * been loaded from the same directory and that have not been replaced
+	 * via addPerspective() are not written again. Each file is replaced
+	 * atomically, so a failed write keeps the previous file.
+	 * \warning The directory is owned by this dock manager: every
+	 * *.perspective file in it that does not belong to one of the current
+	 * perspectives is deleted. Do not share the directory with other dock
+	 * managers or applications that store their own perspectives there.
+	 * Returns false, if a perspective could not be written or if a file
+	 * could not be deleted.
+	 */
+	bool savePerspectives(const QString& DirName) const;
+
+	/**
+	 * Loads the perspectives that have been saved into the given directory
+	 * via savePerspectives(const QString&).
+	 * Only the perspective names are read here. A perspective file is read
+	 * and decoded the first time the perspective is opened, so invalid
+	 * perspectives are only detected by openPerspective()
+	 */
+	void loadPerspectives(const QString& DirName);
+
+	/**
+	 * Returns the estimated number of bytes that are used by the stored
+	 * perspectives. This includes the saved state data and the decoded
+	 * state trees
+	 */
+	qint64 perspectivesMemoryUsage() const;
+
+	/**
+	 * Returns the perspective cache limit in bytes.
+	 * \see setPerspectiveCacheLimit()
+	 */
+	qint64 perspectiveCacheLimit() const;
+
+	/**
+	 * Limits the memory used by the stored perspectives to the given
+	 * number of bytes. If the limit is exceeded, the decoded state trees of
+	 * the least recently used perspectives are released and decoded again
+	 * the next time the perspective is opened. The saved state data is
+	 * always kept. A limit of 0 means, that the memory usage is not
+	 * limited. This is the default.
+	 */
+	void setPerspectiveCacheLimit(qint64 Bytes);
+
 	/**
 	 * Adds a toggle view action to the the internal view menu.
 	 * You can either manage the insertion of the toggle view actions in your
@@ -316,12 +599,73 @@ public:
 	 */
 	bool isRestoringState() const;
 
+	/**
+	 * Starts a batch update of the dock manager.
+	 * Use this, if you add many dock widgets in code, i.e. to build a
+	 * default layout. Until the matching endUpdate() call, the dock
+	 * containers do not emit dockAreasAdded() and dockAreasRemoved(), the
+	 * title bars of the dock areas are not updated and the dock manager does
+	 * not repaint. All deferred work is done once in endUpdate().
+	 * Calls can be nested. Use CDockManagerUpdateGuard to ensure, that every
+	 * beginUpdate() call has a matching endUpdate() call.
+	 */
+	void beginUpdate();
+
+	/**
+	 * Ends a batch update that has been started with beginUpdate().
+	 * If this is the outermost call, the deferred signals and updates are
+	 * flushed.
+	 */
+	void endUpdate();
+
+	/**
+	 * Returns true between beginUpdate() and the matching endUpdate() call
+	 */
+	bool isUpdating() const;
+
 	/**
 	 * The distance the user needs to move the mouse with the left button
 	 * hold down before a dock widget start floating
 	 */
 	static int startDragDistance();
 
+	/**
+	 * Returns the default stylesheet of the docking system. The stylesheet
+	 * resource is read only once and then cached.
+	 */
+	static QString defaultStyleSheet();
+
+	/**
+	 * Sets the global stylesheet mode. The mode is used by all dock managers
+	 * that are created afterwards, so call this before you create the first
+	 * dock manager.
+	 * Stylesheet polishing is expensive if many tabs are created. With
+	 * ApplicationStyleSheet, the stylesheet is parsed only once for all dock
+	 * managers. With NoStyleSheet, the application is responsible for the
+	 * look of the docking system, i.e. via a QProxyStyle that evaluates
+	 * CDockWidgetTab::isActiveTab().
+	 */
+	static void setStyleSheetMode(eStyleSheetMode Mode);
+
+	/**
+	 * Returns the global stylesheet mode
+	 */
+	static eStyleSheetMode styleSheetMode();
+
+	/**
+	 * Installs the given instrumentation that receives timed scopes and
+	 * counters from the hot paths of the docking system, i.e. for a tracing
+	 * backend. The instrumentation is used by all dock managers. Pass a
+	 * nullptr to uninstall it. The dock manager does not take ownership.
+	 * \see CDockInstrumentation
+	 */
+	static void setInstrumentation(CDockInstrumentation* Instrumentation);
+
+	/**
+	 * Returns the installed instrumentation or a nullptr
+	 */
+	static CDockInstrumentation* instrumentation();
+
 public slots:
 	/**
 	 * Opens the perspective with the given name.
@@ -353,6 +697,20 @@ signals:
      */
     void stateRestored();
 
+    /**
+     * This signal is emitted during restoreStateAsync() each time the
+     * content of a dock widget has been created. Done is the number of
+     * created contents and Total the number of contents to create.
+     */
+    void restoreProgress(int Done, int Total);
+
+    /**
+     * This signal is emitted if an asynchronous restore finished.
+     * Success is false, if the state could not be decoded or if the version
+     * did not match.
+     */
+    void asyncRestoreFinished(bool Success);
+
     /**
      * This signal is emitted, if the dock manager starts opening a
      * perspective.
@@ -369,6 +727,31 @@ signals:
      */
     void perspectiveOpened(const QString& PerspectiveName);
 }; // class DockManager
+
+
+/**
+ * Scoped guard for batch updates of the dock manager.
+ * The constructor calls CDockManager::beginUpdate() and the destructor
+ * calls CDockManager::endUpdate()
+ */
+class CDockManagerUpdateGuard
+{
+private:
+	CDockManager* m_DockManager;
+	Q_DISABLE_COPY(CDockManagerUpdateGuard)
+
+public:
+	explicit CDockManagerUpdateGuard(CDockManager* DockManager)
+		: m_DockManager(DockManager)
+	{
+		m_DockManager->beginUpdate();
+	}
+
+	~CDockManagerUpdateGuard()
+	{
+		m_DockManager->endUpdate();
+	}
+};
 } // namespace ads
 //-----------------------------------------------------------------------------
 #endif // DockManagerH
@@ -35,13 +35,19 @@
 #include <QDebug>
 #include <QMap>
 #include <QWindow>
+#include <QPixmapCache>
+#include <QRubberBand>
 
 #include "DockAreaWidget.h"
+#include "DockManager.h"
+#include "DockInstrumentation.h"
 
 #include <iostream>
 
 namespace ads
 {
+static quint64 DropIndicatorCacheHits = 0;
+static quint64 DropIndicatorCacheMisses = 0;
 
 /**
  * Private data class of CDockOverlay
@@ -53,15 +59,41 @@ struct DockOverlayPrivate
 	CDockOverlayCross* Cross;
 	QPointer<QWidget> TargetWidget;
 	QRect TargetRect;
+	QRect TargetTitleBarRect;
 	DockWidgetArea LastLocation = InvalidDockWidgetArea;
 	bool DropPreviewEnabled = true;
 	CDockOverlay::eMode Mode = CDockOverlay::ModeDockAreaOverlay;
 	QRect DropAreaRect;
+	CDockManager* DockManager = nullptr;
+	QRubberBand* RubberBand = nullptr;
 
 	/**
 	 * Private data constructor
 	 */
 	DockOverlayPrivate(CDockOverlay* _public) : _this(_public) {}
+
+	/**
+	 * Returns true, if the LightweightDropOverlay config flag is set
+	 */
+	bool isLightweight() const
+	{
+		return DockManager && DockManager->configFlags().testFlag(
+			CDockManager::LightweightDropOverlay);
+	}
+
+	/**
+	 * Returns the drop preview rectangle for the given area in overlay
+	 * coordinates
+	 */
+	QRect dropPreviewRect(DockWidgetArea Area) const;
+
+	/**
+	 * Updates the drop preview for the given area.
+	 * The translucent overlay window only repaints the union of the old and
+	 * the new preview rectangle. In lightweight mode, the rubber band is
+	 * moved to the new preview rectangle.
+	 */
+	void updateDropPreview(DockWidgetArea Area);
 };
 
 /**
@@ -78,6 +110,17 @@ struct DockOverlayCrossPrivate
 	bool UpdateRequired = false;
 	double LastDevicePixelRatio = 0.1;
 
+	/**
+	 * Global rectangle of a visible drop indicator
+	 */
+	struct HitRect
+	{
+		QRect Rect;
+		DockWidgetArea Area;
+	};
+	HitRect HitRects[5];
+	int HitRectCount = 0;
+
 	/**
 	 * Private data constructor
 	 */
@@ -90,6 +133,20 @@ struct DockOverlayCrossPrivate
 	 */
 	QPoint areaGridPosition(const DockWidgetArea area);
 
+	/**
+	 * Computes the global rectangles of all visible and allowed drop
+	 * indicator widgets
+	 */
+	void updateHitRects();
+
+	/**
+	 * In lightweight mode, the cross window is masked to the visible drop
+	 * indicators. Without a compositor, the translucent background of the
+	 * cross would be painted black, so the cross must not show anything
+	 * but the indicators
+	 */
+	void updateMask(bool Lightweight);
+
 
 	/**
 	 * Palette based default icon colors
@@ -177,17 +234,52 @@ struct DockOverlayCrossPrivate
 	}
 
 	//============================================================================
+	/**
+	 * Returns the drop indicator pixmap for the given area, mode, size and
+	 * the device pixel ratio of the cross window. The pixmaps are stored in
+	 * the global QPixmapCache. The cache key contains all icon colors,
+	 * so pixmaps are shared between all overlay crosses with the same
+	 * colors and between screens with the same device pixel ratio.
+	 */
 	QPixmap createHighDpiDropIndicatorPixmap(const QSizeF& size, DockWidgetArea DockWidgetArea,
 		CDockOverlay::eMode Mode)
 	{
-		QColor borderColor = iconColor(CDockOverlayCross::FrameColor);
-		QColor backgroundColor = iconColor(CDockOverlayCross::WindowBackgroundColor);
-
 #if QT_VERSION >= 0x050600
 		double DevicePixelRatio = _this->window()->devicePixelRatioF();
 #else
         double DevicePixelRatio = _this->window()->devicePixelRatio();
 #endif
+		QString Key = QString("ads_dropindicator_%1_%2_%3x%4_%5")
+			.arg(DockWidgetArea).arg(Mode).arg(size.width()).arg(size.height())
+			.arg(DevicePixelRatio);
+		for (int i = CDockOverlayCross::FrameColor; i <= CDockOverlayCross::ShadowColor; ++i)
+		{
+			Key += '_' + QString::number(iconColor(static_cast<CDockOverlayCross::eIconColor>(i)).rgba(), 16);
+		}
+
+		QPixmap pm;
+		if (QPixmapCache::find(Key, &pm))
+		{
+			DropIndicatorCacheHits++;
+			return pm;
+		}
+
+		DropIndicatorCacheMisses++;
+		pm = renderDropIndicatorPixmap(size, DockWidgetArea, Mode, DevicePixelRatio);
+		QPixmapCache::insert(Key, pm);
+		return pm;
+	}
+
+	//============================================================================
+	/**
+	 * Paints the drop indicator pixmap for the given area and mode
+	 */
+	QPixmap renderDropIndicatorPixmap(const QSizeF& size, DockWidgetArea DockWidgetArea,
+		CDockOverlay::eMode Mode, double DevicePixelRatio)
+	{
+		QColor borderColor = iconColor(CDockOverlayCross::FrameColor);
+		QColor backgroundColor = iconColor(CDockOverlayCross::WindowBackgroundColor);
+
 		QSizeF PixmapSize = size * DevicePixelRatio;
 		QPixmap pm(PixmapSize.toSize());
 		pm.fill(QColor(0, 0, 0, 0));
@@ -326,12 +418,68 @@ struct DockOverlayCrossPrivate
 };
 
 
+//============================================================================
+QRect DockOverlayPrivate::dropPreviewRect(DockWidgetArea Area) const
+{
+	QRect r = _this->rect();
+	double Factor = (CDockOverlay::ModeContainerOverlay == Mode) ?
+		3 : 2;
+
+	switch (Area)
+	{
+    case TopDockWidgetArea: r.setHeight(r.height() / Factor); break;
+	case RightDockWidgetArea: r.setX(r.width() * (1 - 1 / Factor)); break;
+	case BottomDockWidgetArea: r.setY(r.height() * (1 - 1 / Factor)); break;
+	case LeftDockWidgetArea: r.setWidth(r.width() / Factor); break;
+	case CenterDockWidgetArea: break;
+	default: return QRect();
+	}
+	return r;
+}
+
+
+//============================================================================
+void DockOverlayPrivate::updateDropPreview(DockWidgetArea Area)
+{
+	QRect Rect = DropPreviewEnabled ? dropPreviewRect(Area) : QRect();
+	if (Rect == DropAreaRect)
+	{
+		return;
+	}
+
+	QRect OldRect = DropAreaRect;
+	DropAreaRect = Rect;
+	if (!isLightweight())
+	{
+		_this->update(OldRect.united(Rect));
+		return;
+	}
+
+	if (!Rect.isValid())
+	{
+		if (RubberBand)
+		{
+			RubberBand->hide();
+		}
+		return;
+	}
+
+	if (!RubberBand)
+	{
+		RubberBand = new QRubberBand(QRubberBand::Rectangle);
+	}
+	RubberBand->setGeometry(QRect(_this->mapToGlobal(Rect.topLeft()), Rect.size()));
+	RubberBand->show();
+}
+
+
 //============================================================================
 CDockOverlay::CDockOverlay(QWidget* parent, eMode Mode) :
 	QFrame(parent),
 	d(new DockOverlayPrivate(this))
 {
 	d->Mode = Mode;
+	d->DockManager = qobject_cast<CDockManager*>(parent);
 	d->Cross = new CDockOverlayCross(this);
 	setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
 	setWindowOpacity(1);
@@ -347,6 +495,7 @@ CDockOverlay::CDockOverlay(QWidget* parent, eMode Mode) :
 //============================================================================
 CDockOverlay::~CDockOverlay()
 {
+	delete d->RubberBand;
 	delete d;
 }
 
@@ -371,19 +520,22 @@ DockWidgetAreas CDockOverlay::allowedAreas() const
 //============================================================================
 DockWidgetArea CDockOverlay::dropAreaUnderCursor() const
 {
-	DockWidgetArea Result = d->Cross->cursorLocation();
-	if (Result != InvalidDockWidgetArea)
-	{
-		return Result;
-	}
+	return dropAreaAt(QCursor::pos());
+}
+
 
-	CDockAreaWidget* DockArea = dynamic_cast<CDockAreaWidget*>(d->TargetWidget.data());
-	if (!DockArea)
+//============================================================================
+DockWidgetArea CDockOverlay::dropAreaAt(const QPoint& GlobalPos) const
+{
+	DockWidgetArea Result = d->Cross->cursorLocation(GlobalPos);
+	if (Result != InvalidDockWidgetArea)
 	{
 		return Result;
 	}
 
-	if (DockArea->titleBarGeometry().contains(DockArea->mapFromGlobal(QCursor::pos())))
+	// The global title bar rectangle is only valid, if the target is a
+	// dock area
+	if (d->TargetWidget && d->TargetTitleBarRect.contains(GlobalPos))
 	{
 		return CenterDockWidgetArea;
 	}
@@ -394,31 +546,74 @@ DockWidgetArea CDockOverlay::dropAreaUnderCursor() const
 
 //============================================================================
 DockWidgetArea CDockOverlay::showOverlay(QWidget* target)
+{
+	return showOverlay(target, QCursor::pos());
+}
+
+
+//============================================================================
+DockWidgetArea CDockOverlay::showOverlay(QWidget* target, const QPoint& GlobalPos)
 {
 	if (d->TargetWidget == target)
 	{
 		// Hint: We could update geometry of overlay here.
-		DockWidgetArea da = dropAreaUnderCursor();
+		DockWidgetArea da = dropAreaAt(GlobalPos);
 		if (da != d->LastLocation)
 		{
-			repaint();
 			d->LastLocation = da;
+			d->updateDropPreview(da);
 		}
 		return da;
 	}
 
 	d->TargetWidget = target;
 	d->TargetRect = QRect();
-	d->LastLocation = InvalidDockWidgetArea;
+	d->TargetTitleBarRect = QRect();
+	CDockAreaWidget* DockArea = qobject_cast<CDockAreaWidget*>(target);
+	if (DockArea)
+	{
+		QRect TitleBarRect = DockArea->titleBarGeometry();
+		d->TargetTitleBarRect = QRect(DockArea->mapToGlobal(TitleBarRect.topLeft()),
+			TitleBarRect.size());
+	}
+
+	// Move it over the target. The overlay window is only changed, if the
+	// new target has another geometry
+	QRect TargetGeometry(target->mapToGlobal(QPoint(0, 0)), target->size());
+	if (geometry() != TargetGeometry)
+	{
+		// The preview of the previous target needs to be removed, because
+		// the new preview may be empty
+		d->DropAreaRect = QRect();
+		if (d->RubberBand)
+		{
+			d->RubberBand->hide();
+		}
+		setGeometry(TargetGeometry);
+	}
 
-	// Move it over the target.
-	resize(target->size());
-	QPoint TopLeft = target->mapToGlobal(target->rect().topLeft());
-	move(TopLeft);
-	show();
+	// In lightweight mode, the translucent overlay window is never shown.
+	// Only the drop indicators of the cross and the rubber band of the drop
+	// preview are visible. The cross is an opaque window that is masked to
+	// the indicators. The translucency can only be disabled, before the
+	// native window is created
+	if (d->isLightweight() && !d->Cross->windowHandle())
+	{
+		d->Cross->setAttribute(Qt::WA_TranslucentBackground, false);
+	}
 	d->Cross->updatePosition();
+	if (d->isLightweight())
+	{
+		d->Cross->setVisible(allowedAreas() != NoDockWidgetArea);
+	}
+	else
+	{
+		show();
+	}
 	d->Cross->updateOverlayIcons();
-	return dropAreaUnderCursor();
+	d->LastLocation = dropAreaAt(GlobalPos);
+	d->updateDropPreview(d->LastLocation);
+	return d->LastLocation;
 }
 
 
@@ -426,6 +621,13 @@ DockWidgetArea CDockOverlay::showOverlay(QWidget* target)
 void CDockOverlay::hideOverlay()
 {
 	hide();
+	d->Cross->hide();
+	if (d->RubberBand)
+	{
+		d->RubberBand->hide();
+	}
+	d->DropAreaRect = QRect();
+	d->TargetTitleBarRect = QRect();
 	d->TargetWidget.clear();
 	d->TargetRect = QRect();
 	d->LastLocation = InvalidDockWidgetArea;
@@ -435,8 +637,12 @@ void CDockOverlay::hideOverlay()
 //============================================================================
 void CDockOverlay::enableDropPreview(bool Enable)
 {
+	if (d->DropPreviewEnabled == Enable)
+	{
+		return;
+	}
 	d->DropPreviewEnabled = Enable;
-	update();
+	d->updateDropPreview(d->LastLocation);
 }
 
 
@@ -444,27 +650,15 @@ void CDockOverlay::enableDropPreview(bool Enable)
 void CDockOverlay::paintEvent(QPaintEvent* event)
 {
 	Q_UNUSED(event);
-	// Draw rect based on location
-	if (!d->DropPreviewEnabled)
+	ADS_INSTRUMENT_SCOPE(OverlayRepaint);
+	ADS_INSTRUMENT_COUNT(OverlayRepaints);
+	// The drop preview rectangle is computed when the drop area changes, so
+	// the paint event only needs to draw it
+	if (!d->DropAreaRect.isValid())
 	{
-		d->DropAreaRect = QRect();
 		return;
 	}
 
-	QRect r = rect();
-	const DockWidgetArea da = dropAreaUnderCursor();
-	double Factor = (CDockOverlay::ModeContainerOverlay == d->Mode) ?
-		3 : 2;
-
-	switch (da)
-	{
-    case TopDockWidgetArea: r.setHeight(r.height() / Factor); break;
-	case RightDockWidgetArea: r.setX(r.width() * (1 - 1 / Factor)); break;
-	case BottomDockWidgetArea: r.setY(r.height() * (1 - 1 / Factor)); break;
-	case LeftDockWidgetArea: r.setWidth(r.width() / Factor); break;
-	case CenterDockWidgetArea: r = rect();break;
-	default: return;
-	}
 	QPainter painter(this);
     QColor Color = palette().color(QPalette::Active, QPalette::Highlight);
     QPen Pen = painter.pen();
@@ -476,8 +670,29 @@ void CDockOverlay::paintEvent(QPaintEvent* event)
     Color = Color.lighter(130);
     Color.setAlpha(64);
     painter.setBrush(Color);
-	painter.drawRect(r.adjusted(0, 0, -1, -1));
-	d->DropAreaRect = r;
+	painter.drawRect(d->DropAreaRect.adjusted(0, 0, -1, -1));
+}
+
+
+//============================================================================
+quint64 CDockOverlay::iconCacheHitCount()
+{
+	return DropIndicatorCacheHits;
+}
+
+
+//============================================================================
+quint64 CDockOverlay::iconCacheMissCount()
+{
+	return DropIndicatorCacheMisses;
+}
+
+
+//============================================================================
+void CDockOverlay::resetIconCacheCounters()
+{
+	DropIndicatorCacheHits = 0;
+	DropIndicatorCacheMisses = 0;
 }
 
 
@@ -562,6 +777,56 @@ QPoint DockOverlayCrossPrivate::areaGridPosition(const DockWidgetArea area)
 }
 
 
+//============================================================================
+void DockOverlayCrossPrivate::updateHitRects()
+{
+	HitRectCount = 0;
+	const DockWidgetAreas AllowedAreas = DockOverlay->allowedAreas();
+	for (auto it = DropIndicatorWidgets.constBegin(); it != DropIndicatorWidgets.constEnd(); ++it)
+	{
+		QWidget* Widget = it.value();
+		if (!Widget || Widget->isHidden() || !AllowedAreas.testFlag(it.key()))
+		{
+			continue;
+		}
+
+		QRect Geometry = Widget->geometry();
+		HitRects[HitRectCount].Rect = QRect(_this->mapToGlobal(Geometry.topLeft()),
+			Geometry.size());
+		HitRects[HitRectCount].Area = it.key();
+		HitRectCount++;
+	}
+}
+
+
+//============================================================================
+void DockOverlayCrossPrivate::updateMask(bool Lightweight)
+{
+	if (!Lightweight)
+	{
+		if (!_this->mask().isEmpty())
+		{
+			_this->clearMask();
+		}
+		return;
+	}
+
+	QRegion Mask;
+	for (int i = 0; i < HitRectCount; ++i)
+	{
+		const QRect& Rect = HitRects[i].Rect;
+		Mask += QRect(_this->mapFromGlobal(Rect.topLeft()), Rect.size());
+	}
+
+	// An empty mask would remove the mask. The dock overlay does not show
+	// the cross, if no area is allowed
+	if (!Mask.isEmpty())
+	{
+		_this->setMask(Mask);
+	}
+}
+
+
 //============================================================================
 CDockOverlayCross::CDockOverlayCross(CDockOverlay* overlay) :
 	QWidget(overlay->parentWidget()),
@@ -618,7 +883,7 @@ void CDockOverlayCross::updateOverlayIcons()
 	{
 		d->updateDropIndicatorIcon(Widget);
 	}
-#if QT_VESION >= 0x050600
+#if QT_VERSION >= 0x050600
 	d->LastDevicePixelRatio = devicePixelRatioF();
 #else
     d->LastDevicePixelRatio = devicePixelRatio();
@@ -704,17 +969,23 @@ void CDockOverlayCross::setAreaWidgets(const QHash<DockWidgetArea, QWidget*>& wi
 //============================================================================
 DockWidgetArea CDockOverlayCross::cursorLocation() const
 {
-	const QPoint pos = mapFromGlobal(QCursor::pos());
-	QHashIterator<DockWidgetArea, QWidget*> i(d->DropIndicatorWidgets);
-	while (i.hasNext())
+	return cursorLocation(QCursor::pos());
+}
+
+
+//============================================================================
+DockWidgetArea CDockOverlayCross::cursorLocation(const QPoint& GlobalPos) const
+{
+	if (isHidden())
 	{
-		i.next();
-		if (d->DockOverlay->allowedAreas().testFlag(i.key())
-			&& i.value()
-			&& i.value()->isVisible()
-			&& i.value()->geometry().contains(pos))
+		return InvalidDockWidgetArea;
+	}
+
+	for (int i = 0; i < d->HitRectCount; ++i)
+	{
+		if (d->HitRects[i].Rect.contains(GlobalPos))
 		{
-			return i.key();
+			return d->HitRects[i].Area;
 		}
 	}
 	return InvalidDockWidgetArea;
@@ -741,6 +1012,11 @@ void CDockOverlayCross::updatePosition()
 		(this->height() - d->DockOverlay->height()) / 2);
 	QPoint CrossTopLeft = TopLeft - Offest;
 	move(CrossTopLeft);
+	// The layout of a hidden cross is not updated before it is shown. We
+	// activate it here, to get valid drop indicator geometries
+	d->GridLayout->activate();
+	d->updateHitRects();
+	d->updateMask(d->DockOverlay->d->isLightweight());
 }
 
 
@@ -763,6 +1039,9 @@ void CDockOverlayCross::reset()
 			w->setVisible(allowedAreas.testFlag(allAreas.at(i)));
 		}
 	}
+	d->GridLayout->activate();
+	d->updateHitRects();
+	d->updateMask(d->DockOverlay->d->isLightweight());
 }
 
 
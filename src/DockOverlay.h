@@ -45,7 +45,7 @@ class ADS_EXPORT CDockOverlay : public QFrame
 private:
 	DockOverlayPrivate* d; //< private data class
 	friend struct DockOverlayPrivate;
-	friend class DockOverlayCross;
+	friend class CDockOverlayCross;
 
 public:
 	using Super = QFrame;
@@ -82,10 +82,26 @@ public:
 	DockWidgetArea dropAreaUnderCursor() const;
 
 	/**
-	 * Show the drop overly for the given target widget
+	 * Returns the drop area at the given global position.
+	 * Use this function instead of dropAreaUnderCursor() if the cursor
+	 * position is already known, i.e. in a mouse move handler.
+	 */
+	DockWidgetArea dropAreaAt(const QPoint& GlobalPos) const;
+
+	/**
+	 * Show the drop overly for the given target widget.
+	 * If the target did not change, only the changed region of the drop
+	 * preview is repainted. The overlay window is only moved and resized,
+	 * if the geometry of the target changed.
 	 */
 	DockWidgetArea showOverlay(QWidget* target);
 
+	/**
+	 * Show the drop overlay for the given target widget and returns the
+	 * drop area at the given global cursor position
+	 */
+	DockWidgetArea showOverlay(QWidget* target, const QPoint& GlobalPos);
+
 	/**
 	 * Hides the overlay
 	 */
@@ -102,6 +118,25 @@ public:
 	 */
 	QRect dropOverlayRect() const;
 
+	/**
+	 * Returns the number of drop indicator icons that have been taken from
+	 * the pixmap cache instead of being painted.
+	 * The drop indicator pixmaps are cached per area, overlay mode, size,
+	 * device pixel ratio and icon colors.
+	 */
+	static quint64 iconCacheHitCount();
+
+	/**
+	 * Returns the number of drop indicator icons that have been painted
+	 * because they were not in the pixmap cache
+	 */
+	static quint64 iconCacheMissCount();
+
+	/**
+	 * Resets the drop indicator icon cache hit and miss counters
+	 */
+	static void resetIconCacheCounters();
+
 	/**
 	 * Handle polish events
 	 */
@@ -209,6 +244,15 @@ public:
 	 */
 	DockWidgetArea cursorLocation() const;
 
+	/**
+	 * Returns the dock widget area of the drop indicator at the given global
+	 * position.
+	 * The global rectangles of the visible drop indicators are computed in
+	 * updatePosition() and reset(), so this function does not need to
+	 * query any widget.
+	 */
+	DockWidgetArea cursorLocation(const QPoint& GlobalPos) const;
+
 	/**
 	 * Sets up the overlay cross for the given overlay mode
 	 */
@@ -225,7 +269,7 @@ public:
 	void reset();
 
 	/**
-	 * Updates the current position
+	 * Updates the current position and the drop indicator hit rectangles
 	 */
 	void updatePosition();
 
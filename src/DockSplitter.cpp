@@ -31,8 +31,12 @@
 
 #include <QDebug>
 #include <QChildEvent>
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QSet>
 
 #include "DockAreaWidget.h"
+#include "DockInstrumentation.h"
 
 namespace ads
 {
@@ -42,9 +46,79 @@ namespace ads
 struct DockSplitterPrivate
 {
 	CDockSplitter* _this;
-	int VisibleContentCount = 0;
+	QSet<QObject*> VisibleContent;
+	bool AdaptiveOpaqueResize = false;
+	int OpaqueResizeBudget = 16;
 
 	DockSplitterPrivate(CDockSplitter* _public) : _this(_public) {}
+
+	/**
+	 * Updates the visible content set for the given content widget
+	 */
+	void updateVisibleContent(QWidget* Widget)
+	{
+		if (Widget->isHidden())
+		{
+			VisibleContent.remove(Widget);
+		}
+		else
+		{
+			VisibleContent.insert(Widget);
+		}
+	}
+
+	/**
+	 * Called by the splitter handles with the time an opaque splitter move
+	 * has taken. Switches to non opaque resizing, if the move took longer
+	 * than the budget
+	 */
+	void opaqueResizeMeasured(qint64 Milliseconds)
+	{
+		if (AdaptiveOpaqueResize && Milliseconds > OpaqueResizeBudget)
+		{
+			ADS_PRINT("CDockSplitter: opaque resize took " << Milliseconds
+				<< " ms - switching to non opaque resize");
+			_this->setOpaqueResize(false);
+		}
+	}
+};
+
+
+/**
+ * Splitter handle that measures the relayout time of opaque splitter moves
+ * for the adaptive opaque resize mode
+ */
+class CDockSplitterHandle : public QSplitterHandle
+{
+public:
+	using Super = QSplitterHandle;
+
+	CDockSplitterHandle(Qt::Orientation Orientation, CDockSplitter* Parent,
+		DockSplitterPrivate* Private)
+		: QSplitterHandle(Orientation, Parent),
+		  SplitterPrivate(Private)
+	{
+	}
+
+protected:
+	virtual void mouseMoveEvent(QMouseEvent* e) override
+	{
+		if (!SplitterPrivate->AdaptiveOpaqueResize || !opaqueResize()
+		 || !(e->buttons() & Qt::LeftButton))
+		{
+			Super::mouseMoveEvent(e);
+			return;
+		}
+
+		ADS_INSTRUMENT_SCOPE(SplitterResize);
+		QElapsedTimer Timer;
+		Timer.start();
+		Super::mouseMoveEvent(e);
+		SplitterPrivate->opaqueResizeMeasured(Timer.elapsed());
+	}
+
+private:
+	DockSplitterPrivate* SplitterPrivate;
 };
 
 //============================================================================
@@ -54,6 +128,7 @@ CDockSplitter::CDockSplitter(QWidget *parent)
 {
 	setProperty("ads-splitter", true);
 	setChildrenCollapsible(false);
+	ADS_INSTRUMENT_COUNT(WidgetsCreated);
 }
 
 
@@ -62,13 +137,13 @@ CDockSplitter::CDockSplitter(Qt::Orientation orientation, QWidget *parent)
 	: QSplitter(orientation, parent),
 	  d(new DockSplitterPrivate(this))
 {
-
+	ADS_INSTRUMENT_COUNT(WidgetsCreated);
 }
 
 //============================================================================
 CDockSplitter::~CDockSplitter()
 {
-	qDebug() << "~CDockSplitter";
+	ADS_PRINT("~CDockSplitter");
 	delete d;
 }
 
@@ -76,16 +151,102 @@ CDockSplitter::~CDockSplitter()
 //============================================================================
 bool CDockSplitter::hasVisibleContent() const
 {
-	// TODO Cache or precalculate this to speed up
-	for (int i = 0; i < count(); ++i)
+	return !d->VisibleContent.isEmpty();
+}
+
+
+//============================================================================
+void CDockSplitter::childEvent(QChildEvent* event)
+{
+	// QSplitter only keeps content widgets in its widget list. Handles and
+	// the rubber band, that is deleted after each non opaque resize, are
+	// not in the list. The widget is removed from the list by
+	// QSplitter::childEvent(), so we need to test before
+	bool ContentRemoved = event->removed() && event->child()->isWidgetType()
+		&& indexOf(static_cast<QWidget*>(event->child())) >= 0;
+	Super::childEvent(event);
+	// A removed child may already be partially destroyed, so we must not
+	// cast it
+	if (event->removed())
 	{
-		if (!widget(i)->isHidden())
+		event->child()->removeEventFilter(this);
+		d->VisibleContent.remove(event->child());
+		// The expensive content may have been removed - so we try opaque
+		// resizing again
+		if (ContentRemoved && d->AdaptiveOpaqueResize)
 		{
-			return true;
+			setOpaqueResize(true);
 		}
+		return;
+	}
+
+	QWidget* Widget = qobject_cast<QWidget*>(event->child());
+	if (event->added() && Widget && !qobject_cast<QSplitterHandle*>(Widget))
+	{
+		Widget->installEventFilter(this);
+		d->updateVisibleContent(Widget);
+	}
+}
+
+
+//============================================================================
+QSplitterHandle* CDockSplitter::createHandle()
+{
+	return new CDockSplitterHandle(orientation(), this, d);
+}
+
+
+//============================================================================
+void CDockSplitter::setAdaptiveOpaqueResize(bool Enable)
+{
+	d->AdaptiveOpaqueResize = Enable;
+	if (Enable)
+	{
+		setOpaqueResize(true);
+	}
+}
+
+
+//============================================================================
+bool CDockSplitter::adaptiveOpaqueResize() const
+{
+	return d->AdaptiveOpaqueResize;
+}
+
+
+//============================================================================
+void CDockSplitter::setOpaqueResizeBudget(int Milliseconds)
+{
+	d->OpaqueResizeBudget = Milliseconds;
+}
+
+
+//============================================================================
+int CDockSplitter::opaqueResizeBudget() const
+{
+	return d->OpaqueResizeBudget;
+}
+
+
+//============================================================================
+bool CDockSplitter::eventFilter(QObject* watched, QEvent* event)
+{
+	switch (event->type())
+	{
+	case QEvent::Show:
+	case QEvent::ShowToParent:
+	case QEvent::HideToParent:
+		 if (watched->parent() == this)
+		 {
+			 d->updateVisibleContent(static_cast<QWidget*>(watched));
+		 }
+		 break;
+
+	default:
+		break;
 	}
 
-	return false;
+	return Super::eventFilter(watched, event);
 }
 
 } // namespace ads
@@ -47,7 +47,24 @@ private:
 	DockSplitterPrivate* d;
 	friend struct DockSplitterPrivate;
 
+protected:
+	/**
+	 * Tracks the visibility of added and removed content widgets
+	 */
+	virtual void childEvent(QChildEvent* event) override;
+
+	/**
+	 * Tracks explicit show and hide requests of the content widgets
+	 */
+	virtual bool eventFilter(QObject* watched, QEvent* event) override;
+
+	/**
+	 * Creates a handle that measures the relayout time of opaque resizes
+	 */
+	virtual QSplitterHandle* createHandle() override;
+
 public:
+	using Super = QSplitter;
 	CDockSplitter(QWidget *parent = Q_NULLPTR);
 	CDockSplitter(Qt::Orientation orientation, QWidget *parent = Q_NULLPTR);
 
@@ -57,9 +74,38 @@ public:
 	virtual ~CDockSplitter();
 
 	/**
-	 * Returns true, if any of the internal widgets is visible
+	 * Returns true, if any of the internal widgets is visible.
+	 * The splitter tracks the visibility of its content widgets, so this
+	 * function does not need to scan the content widgets.
 	 */
 	bool hasVisibleContent() const;
+
+	/**
+	 * Enables or disables the adaptive opaque resize mode.
+	 * In this mode, the splitter starts with opaque resizing. If a single
+	 * splitter move takes longer than the opaqueResizeBudget(), the splitter
+	 * switches to non opaque resizing, that only shows a rubber band until
+	 * the mouse is released. The splitter tries opaque resizing again, if
+	 * its content widgets change.
+	 */
+	void setAdaptiveOpaqueResize(bool Enable);
+
+	/**
+	 * Returns true, if the adaptive opaque resize mode is enabled
+	 */
+	bool adaptiveOpaqueResize() const;
+
+	/**
+	 * Sets the maximum time in milliseconds a single opaque splitter move
+	 * may take in adaptive opaque resize mode. The default is 16 ms - that
+	 * is one frame at 60 Hz.
+	 */
+	void setOpaqueResizeBudget(int Milliseconds);
+
+	/**
+	 * Returns the opaque resize budget in milliseconds
+	 */
+	int opaqueResizeBudget() const;
 }; // class CDockSplitter
 
 } // namespace ads
@@ -42,6 +42,8 @@
 #include <QDebug>
 #include <QToolBar>
 #include <QXmlStreamWriter>
+#include <QDataStream>
+#include <QTimer>
 
 #include "DockContainerWidget.h"
 #include "DockAreaWidget.h"
@@ -74,6 +76,15 @@ struct DockWidgetPrivate
 	QSize ToolBarIconSizeDocked = QSize(16, 16);
 	QSize ToolBarIconSizeFloating = QSize(24, 24);
 	bool IsFloatingTopLevel = false;
+	CDockWidget::FactoryFunc WidgetFactory;
+	CDockWidget::eInsertMode FactoryInsertMode = CDockWidget::AutoScrollArea;
+	CDockWidget::eContentReleasePolicy ReleasePolicy = CDockWidget::ContentKeep;
+	QTimer* ReleaseTimer = nullptr;
+	CDockWidget::SaveContentStateFunc SaveContentState;
+	CDockWidget::RestoreContentStateFunc RestoreContentState;
+	QVariant ContentState;
+	bool ContentVisible = false;
+	int Id = -1;
 
 	/**
 	 * Private data constructor
@@ -106,6 +117,18 @@ struct DockWidgetPrivate
 	 * Setup the main scroll area
 	 */
 	void setupScrollArea();
+
+	/**
+	 * Starts the release timer if the content of the hidden dock widget
+	 * may be released and stops it if the dock widget is visible
+	 */
+	void updateReleaseTimer();
+
+	/**
+	 * Saves the content state and deletes the content widget if the
+	 * release policy allows it
+	 */
+	void releaseContent();
 };
 // struct DockWidgetPrivate
 
@@ -201,6 +224,63 @@ void DockWidgetPrivate::setupScrollArea()
 }
 
 
+//============================================================================
+void DockWidgetPrivate::updateReleaseTimer()
+{
+	if (!ReleaseTimer)
+	{
+		return;
+	}
+
+	if (Widget && WidgetFactory && !_this->isVisible())
+	{
+		if (!ReleaseTimer->isActive())
+		{
+			ReleaseTimer->start();
+		}
+	}
+	else
+	{
+		ReleaseTimer->stop();
+	}
+}
+
+
+//============================================================================
+void DockWidgetPrivate::releaseContent()
+{
+	if (!Widget || !WidgetFactory || _this->isVisible())
+	{
+		return;
+	}
+
+	if (CDockWidget::ContentReleaseWhenClosed == ReleasePolicy && !Closed)
+	{
+		return;
+	}
+
+	ADS_PRINT("DockWidgetPrivate::releaseContent " << _this->objectName());
+	if (SaveContentState)
+	{
+		ContentState = SaveContentState(Widget);
+	}
+
+	if (ScrollArea)
+	{
+		Layout->removeWidget(ScrollArea);
+		ScrollArea->deleteLater();
+		ScrollArea = nullptr;
+	}
+	else
+	{
+		Layout->removeWidget(Widget);
+		Widget->deleteLater();
+	}
+	Widget = nullptr;
+	emit _this->widgetReleased();
+}
+
+
 //============================================================================
 CDockWidget::CDockWidget(const QString &title, QWidget *parent) :
 	QFrame(parent),
@@ -224,7 +304,11 @@ CDockWidget::CDockWidget(const QString &title, QWidget *parent) :
 //============================================================================
 CDockWidget::~CDockWidget()
 {
-	qDebug() << "~CDockWidget()";
+	ADS_PRINT("~CDockWidget()");
+	if (d->DockManager)
+	{
+		d->DockManager->unregisterDockWidget(this);
+	}
 	delete d;
 }
 
@@ -262,6 +346,108 @@ void CDockWidget::setWidget(QWidget* widget, eInsertMode InsertMode)
 }
 
 
+//============================================================================
+void CDockWidget::setWidgetFactory(const FactoryFunc& Factory,
+	eInsertMode InsertMode)
+{
+	d->WidgetFactory = Factory;
+	d->FactoryInsertMode = InsertMode;
+	if (isVisible())
+	{
+		createWidgetFromFactory();
+	}
+}
+
+
+//============================================================================
+int CDockWidget::dockWidgetId() const
+{
+	return d->Id;
+}
+
+
+//============================================================================
+void CDockWidget::setDockWidgetId(int Id)
+{
+	d->Id = Id;
+}
+
+
+//============================================================================
+bool CDockWidget::isWidgetCreated() const
+{
+	return d->Widget != nullptr;
+}
+
+
+//============================================================================
+void CDockWidget::createWidgetFromFactory()
+{
+	if (d->Widget || !d->WidgetFactory)
+	{
+		return;
+	}
+
+	ADS_PRINT("CDockWidget::createWidgetFromFactory " << objectName());
+	QWidget* Widget = d->WidgetFactory();
+	if (!Widget)
+	{
+		return;
+	}
+
+	setWidget(Widget, d->FactoryInsertMode);
+	if (d->RestoreContentState && d->ContentState.isValid())
+	{
+		d->RestoreContentState(Widget, d->ContentState);
+	}
+	d->ContentState = QVariant();
+	emit widgetCreated(Widget);
+}
+
+
+//============================================================================
+void CDockWidget::setContentReleasePolicy(eContentReleasePolicy Policy,
+	int IdleTime)
+{
+	d->ReleasePolicy = Policy;
+	if (ContentKeep == Policy)
+	{
+		delete d->ReleaseTimer;
+		d->ReleaseTimer = nullptr;
+		return;
+	}
+
+	if (!d->ReleaseTimer)
+	{
+		d->ReleaseTimer = new QTimer(this);
+		d->ReleaseTimer->setSingleShot(true);
+		connect(d->ReleaseTimer, &QTimer::timeout, this, [this]()
+		{
+			d->releaseContent();
+		});
+	}
+	d->ReleaseTimer->setInterval(qMax(0, IdleTime));
+	d->ReleaseTimer->stop();
+	d->updateReleaseTimer();
+}
+
+
+//============================================================================
+CDockWidget::eContentReleasePolicy CDockWidget::contentReleasePolicy() const
+{
+	return d->ReleasePolicy;
+}
+
+
+//============================================================================
+void CDockWidget::setContentStateFunctions(const SaveContentStateFunc& SaveFunc,
+	const RestoreContentStateFunc& RestoreFunc)
+{
+	d->SaveContentState = SaveFunc;
+	d->RestoreContentState = RestoreFunc;
+}
+
+
 //============================================================================
 QWidget* CDockWidget::takeWidget()
 {
@@ -390,6 +576,38 @@ bool CDockWidget::isClosed() const
 }
 
 
+//============================================================================
+bool CDockWidget::isContentVisible() const
+{
+	if (d->Closed || !isVisible() || window()->isMinimized())
+	{
+		return false;
+	}
+
+	if (!d->DockManager || !d->DockArea)
+	{
+		return true;
+	}
+
+	QRect GlobalRect(mapToGlobal(QPoint(0, 0)), size());
+	return !d->DockManager->isCoveredByFloatingWidget(GlobalRect, dockContainer());
+}
+
+
+//============================================================================
+void CDockWidget::updateContentVisibility()
+{
+	bool Visible = isContentVisible();
+	if (Visible == d->ContentVisible)
+	{
+		return;
+	}
+
+	d->ContentVisible = Visible;
+	emit visibilityChanged(Visible);
+}
+
+
 //============================================================================
 QAction* CDockWidget::toggleViewAction() const
 {
@@ -479,6 +697,8 @@ void CDockWidget::toggleViewInternal(bool Open)
 		FloatingContainer->updateWindowTitle();
 	}
 
+	d->updateReleaseTimer();
+	updateContentVisibility();
 	if (!Open)
 	{
 		emit closed();
@@ -505,6 +725,13 @@ void CDockWidget::saveState(QXmlStreamWriter& s) const
 }
 
 
+//============================================================================
+void CDockWidget::saveState(QDataStream& s) const
+{
+	s << objectName() << d->Closed;
+}
+
+
 //============================================================================
 void CDockWidget::flagAsUnassigned()
 {
@@ -536,6 +763,35 @@ bool CDockWidget::event(QEvent *e)
 		}
 		emit titleChanged(title);
 	}
+	else if (e->type() == QEvent::Show || e->type() == QEvent::Hide)
+	{
+		// The content of a factory created dock widget is created, when the
+		// dock widget is shown the first time or after its content has been
+		// released. While a state is restored, the dock manager creates the
+		// contents of the current dock widgets after the restore. While an
+		// asynchronous restore creates contents, this dock widget is next
+		if (e->type() == QEvent::Show && !isWidgetCreated()
+		 && (!d->DockManager || (!d->DockManager->isRestoringState()
+		 && !d->DockManager->prioritizeWidgetContent(this))))
+		{
+			createWidgetFromFactory();
+		}
+
+		// Minimizing a window causes spontaneous hide events. The content
+		// of a minimized window should not be released
+		if (!e->spontaneous())
+		{
+			d->updateReleaseTimer();
+		}
+
+		updateContentVisibility();
+		// The window state may not be up to date yet, if the window is
+		// minimized or restored, so we check the visibility again later
+		if (d->DockManager)
+		{
+			d->DockManager->scheduleDockWidgetVisibilityUpdate(this);
+		}
+	}
 	return Super::event(e);
 }
 
@@ -720,6 +976,11 @@ void CDockWidget::emitTopLevelChanged(bool Floating)
 void CDockWidget::setClosedState(bool Closed)
 {
 	d->Closed = Closed;
+	CDockContainerWidget* DockContainer = d->DockArea ? dockContainer() : nullptr;
+	if (DockContainer)
+	{
+		DockContainer->invalidateTopLevelDockWidget();
+	}
 }
 
 
@@ -31,11 +31,15 @@
 //                                   INCLUDES
 //============================================================================
 #include <QFrame>
+#include <QVariant>
 
 #include "ads_globals.h"
 
+#include <functional>
+
 class QToolBar;
 class QXmlStreamWriter;
+class QDataStream;
 
 namespace ads
 {
@@ -74,6 +78,7 @@ protected:
 	friend class CDockAreaTabBar;
 	friend class CDockWidgetTab;
 	friend struct DockWidgetTabPrivate;
+	friend struct FloatingDragPreviewPrivate;
 
 	/**
 	 * Assigns the dock manager that manages this dock widget
@@ -99,6 +104,11 @@ protected:
 	 */
 	void saveState(QXmlStreamWriter& Stream) const;
 
+	/**
+	 * Saves the state into the given binary stream
+	 */
+	void saveState(QDataStream& Stream) const;
+
 	/**
 	 * This is a helper function for the dock manager to flag this widget
 	 * as unassigned.
@@ -135,6 +145,26 @@ protected:
 	 */
 	void toggleViewInternal(bool Open);
 
+	/**
+	 * Creates the content widget via the widget factory if a factory has
+	 * been assigned and if the content widget does not exist yet.
+	 * The dock widget calls this function when it is shown and the dock
+	 * manager calls it after a state has been restored.
+	 */
+	void createWidgetFromFactory();
+
+	/**
+	 * The dock manager assigns the numeric dock widget id when the dock
+	 * widget is registered
+	 */
+	void setDockWidgetId(int Id);
+
+	/**
+	 * Updates the content visibility and emits the visibilityChanged()
+	 * signal if it changed
+	 */
+	void updateContentVisibility();
+
 public:
 	using Super = QFrame;
 
@@ -193,6 +223,18 @@ public:
 		ActionModeShow   //!< ActionModeShow
 	};
 
+	/**
+	 * Configures, when the content widget of a dock widget with a widget
+	 * factory is released.
+	 * \see setContentReleasePolicy()
+	 */
+	enum eContentReleasePolicy
+	{
+		ContentKeep,             //!< the content is never released
+		ContentReleaseWhenClosed,//!< the content is released if the dock widget is closed
+		ContentReleaseWhenHidden //!< the content is released if the dock widget is closed or hidden in an inactive tab
+	};
+
 
 	/**
 	 * This constructor creates a dock widget with the given title.
@@ -238,6 +280,67 @@ public:
 	 */
 	void setWidget(QWidget* widget, eInsertMode InsertMode = AutoScrollArea);
 
+	/**
+	 * Function that creates the content widget of a dock widget on demand
+	 */
+	using FactoryFunc = std::function<QWidget*()>;
+
+	/**
+	 * Sets a factory function that creates the content widget later.
+	 * The tab, the toggle view action and the place in the layout exist
+	 * immediately, but the content widget is created the first time the dock
+	 * widget becomes the current dock widget of its dock area or is opened.
+	 * Restoring a state does not create the content of dock widgets that are
+	 * closed or that are not the current dock widget in their dock area.
+	 * The created widget is inserted with the given InsertMode like in
+	 * setWidget(). Until the widget has been created, widget() returns 0.
+	 */
+	void setWidgetFactory(const FactoryFunc& Factory,
+		eInsertMode InsertMode = AutoScrollArea);
+
+	/**
+	 * Returns true, if the content widget exists. This function returns
+	 * false, if a widget factory has been assigned and the dock widget has
+	 * not been shown yet or if the content has been released.
+	 */
+	bool isWidgetCreated() const;
+
+	/**
+	 * Function that saves the state of the content widget before the
+	 * content is released
+	 */
+	using SaveContentStateFunc = std::function<QVariant(QWidget*)>;
+
+	/**
+	 * Function that restores the saved state into the content widget that
+	 * has been created again by the widget factory
+	 */
+	using RestoreContentStateFunc = std::function<void(QWidget*, const QVariant&)>;
+
+	/**
+	 * Sets the policy for releasing the content widget of a dock widget
+	 * that has been created via a widget factory.
+	 * If the dock widget is closed or hidden for longer than IdleTime
+	 * milliseconds, the content widget is deleted to reclaim memory. The
+	 * widget factory creates it again the next time the dock widget is
+	 * opened or becomes the current dock widget of its dock area.
+	 * The default policy is ContentKeep.
+	 */
+	void setContentReleasePolicy(eContentReleasePolicy Policy, int IdleTime = 60000);
+
+	/**
+	 * Returns the content release policy
+	 */
+	eContentReleasePolicy contentReleasePolicy() const;
+
+	/**
+	 * Sets the functions that save the state of the content widget before
+	 * it is released and that restore the state after the content widget has
+	 * been created again
+	 */
+	void setContentStateFunctions(const SaveContentStateFunc& SaveFunc,
+		const RestoreContentStateFunc& RestoreFunc);
+
 	/**
 	 * Remove the widget from the dock and give ownership back to the caller
 	 */
@@ -311,6 +414,27 @@ public:
 	 */
 	bool isClosed() const;
 
+	/**
+	 * Returns the numeric id that the dock manager assigned to this dock
+	 * widget when it has been added to the dock manager the first time.
+	 * The id is unique within the dock manager and never changes. The
+	 * function returns -1, if the dock widget has never been added to a
+	 * dock manager.
+	 * \see CDockManager::findDockWidget(int)
+	 */
+	int dockWidgetId() const;
+
+	/**
+	 * Returns true, if the content of this dock widget is visible to the
+	 * user.
+	 * The content is not visible, if the dock widget is closed, if it is
+	 * hidden in an inactive tab, if its window is minimized or if it is
+	 * completely covered by a floating widget. Use this function and the
+	 * visibilityChanged() signal to pause expensive rendering of content
+	 * that the user can not see.
+	 */
+	bool isContentVisible() const;
+
 	/**
 	 * Returns a checkable action that can be used to show or close this dock widget.
 	 * The action's text is set to the dock widget's window title.
@@ -436,6 +560,25 @@ signals:
 	 * otherwise it is false.
 	 */
 	void topLevelChanged(bool topLevel);
+
+	/**
+	 * This signal is emitted if the content widget has been created by the
+	 * widget factory
+	 */
+	void widgetCreated(QWidget* Widget);
+
+	/**
+	 * This signal is emitted if the content widget has been released
+	 * because of the content release policy
+	 */
+	void widgetReleased();
+
+	/**
+	 * This signal is emitted if the content visibility of this dock widget
+	 * changed.
+	 * \see isContentVisible()
+	 */
+	void visibilityChanged(bool Visible);
 }; // class DockWidget
 }
  // namespace ads
@@ -46,6 +46,7 @@
 #include "DockWidget.h"
 #include "DockAreaWidget.h"
 #include "FloatingDockContainer.h"
+#include "FloatingDragPreview.h"
 #include "DockOverlay.h"
 #include "DockManager.h"
 
@@ -70,7 +71,7 @@ struct DockWidgetTabPrivate
 	bool IsActiveTab = false;
 	CDockAreaWidget* DockArea = nullptr;
 	eDragState DragState = DraggingInactive;
-	CFloatingDockContainer* FloatingWidget = nullptr;
+	IFloatingWidget* FloatingWidget = nullptr;
 	QIcon Icon;
 	tCloseButton* CloseButton = nullptr;
 	QSpacerItem* IconTextSpacer;
@@ -193,9 +194,9 @@ void DockWidgetTabPrivate::moveTab(QMouseEvent* ev)
 bool DockWidgetTabPrivate::startFloating(eDragState DraggingState)
 {
 	auto dockContainer = DockWidget->dockContainer();
-	qDebug() << "isFloating " << dockContainer->isFloating();
-	qDebug() << "areaCount " << dockContainer->dockAreaCount();
-	qDebug() << "widgetCount " << DockWidget->dockAreaWidget()->dockWidgetsCount();
+	ADS_PRINT("isFloating " << dockContainer->isFloating());
+	ADS_PRINT("areaCount " << dockContainer->dockAreaCount());
+	ADS_PRINT("widgetCount " << DockWidget->dockAreaWidget()->dockWidgetsCount());
 	// if this is the last dock widget inside of this floating widget,
 	// then it does not make any sense, to make it floating because
 	// it is already floating
@@ -206,9 +207,22 @@ bool DockWidgetTabPrivate::startFloating(eDragState DraggingState)
 		return false;
 	}
 
-	qDebug() << "startFloating";
+	ADS_PRINT("startFloating");
 	DragState = DraggingState;
 	QSize Size = DockArea->size();
+	if (DraggingFloatingWidget == DraggingState
+	 && testConfigFlag(CDockManager::GhostDragPreview))
+	{
+		// The preview only moves a snapshot of the content. The content
+		// itself stays in its dock area until it is dropped
+		CFloatingDragPreview* Preview = (DockArea->dockWidgetsCount() > 1)
+			? new CFloatingDragPreview(DockWidget)
+			: new CFloatingDragPreview(DockArea);
+		Preview->startFloating(DragStartMousePosition, Size, DraggingState, _this);
+		this->FloatingWidget = Preview;
+		return true;
+	}
+
 	CFloatingDockContainer* FloatingWidget = nullptr;
 	if (DockArea->dockWidgetsCount() > 1)
 	{
@@ -251,7 +265,7 @@ CDockWidgetTab::CDockWidgetTab(CDockWidget* DockWidget, QWidget *parent) :
 //============================================================================
 CDockWidgetTab::~CDockWidgetTab()
 {
-	qDebug() << "~CDockWidgetTab()";
+	ADS_PRINT("~CDockWidgetTab()");
 	delete d;
 }
 
@@ -381,10 +395,15 @@ void CDockWidgetTab::setActiveTab(bool active)
 	}
 
 	d->IsActiveTab = active;
-	style()->unpolish(this);
-	style()->polish(this);
-	d->TitleLabel->style()->unpolish(d->TitleLabel);
-	d->TitleLabel->style()->polish(d->TitleLabel);
+	// Only stylesheets need a repolish to evaluate the activeTab property.
+	// A QStyle or palette based theme just needs a repaint
+	if (testAttribute(Qt::WA_StyleSheet))
+	{
+		style()->unpolish(this);
+		style()->polish(this);
+		d->TitleLabel->style()->unpolish(d->TitleLabel);
+		d->TitleLabel->style()->polish(d->TitleLabel);
+	}
 	update();
 
 	emit activeTabChanged();
@@ -29,10 +29,48 @@
 //============================================================================
 #include <ElidingLabel.h>
 #include <QMouseEvent>
+#include <QCache>
+#include <QHash>
 
 
 namespace ads
 {
+/**
+ * Key of the elided text cache that is shared by all eliding labels
+ */
+struct ElidedTextKey
+{
+	QString Text;
+	QString FontKey;
+	int Width;
+	int Mode;
+
+	bool operator==(const ElidedTextKey& Other) const
+	{
+		return Width == Other.Width && Mode == Other.Mode
+			&& Text == Other.Text && FontKey == Other.FontKey;
+	}
+};
+
+inline uint qHash(const ElidedTextKey& Key, uint Seed = 0)
+{
+	return ::qHash(Key.Text, Seed) ^ ::qHash(Key.FontKey, Seed)
+		^ ::qHash(Key.Width, Seed) ^ uint(Key.Mode);
+}
+
+
+/**
+ * Returns the elided text cache that is shared by all eliding labels.
+ * All labels with the same font, text, width and elide mode share one
+ * cache entry
+ */
+static QCache<ElidedTextKey, QString>& elidedTextCache()
+{
+	static QCache<ElidedTextKey, QString> Cache(2048);
+	return Cache;
+}
+
+
 /**
  * Private data of public CClickableLabel
  */
@@ -41,11 +79,34 @@ struct ElidingLabelPrivate
 	CElidingLabel* _this;
 	Qt::TextElideMode ElideMode = Qt::ElideNone;
 	QString Text;
+	int TextWidth = -1;///< cached width of the complete text, -1 if invalid
+	int ElidedWidth = -1;///< available width of the current elided text
 
 	ElidingLabelPrivate(CElidingLabel* _public) : _this(_public) {}
 
 	void elideText(int Width);
 
+	/**
+	 * Returns the width of the complete text for the current font
+	 */
+	int textWidth()
+	{
+		if (TextWidth < 0)
+		{
+			TextWidth = _this->fontMetrics().width(Text);
+		}
+		return TextWidth;
+	}
+
+	/**
+	 * Invalidates the cached text width and the elided text
+	 */
+	void invalidate()
+	{
+		TextWidth = -1;
+		ElidedWidth = -1;
+	}
+
 	/**
 	 * Convenience function to check if the
 	 */
@@ -63,13 +124,43 @@ void ElidingLabelPrivate::elideText(int Width)
 	{
 		return;
 	}
-    QFontMetrics fm = _this->fontMetrics();
-    QString  str = fm.elidedText(Text, ElideMode, Width - _this->margin() * 2 - _this->indent());
-    if (str == "…")
-    {
-    	str = Text.at(0);
-    }
-    _this->QLabel::setText(str);
+
+	int AvailableWidth = Width - _this->margin() * 2 - _this->indent();
+	if (AvailableWidth == ElidedWidth)
+	{
+		return;
+	}
+
+	// If the complete text fits into the label, then there is nothing to
+	// elide. If the text did already fit before, then the width change
+	// does not change the label text at all
+	bool TextFits = AvailableWidth >= textWidth();
+	bool TextFitted = ElidedWidth >= 0 && ElidedWidth >= textWidth();
+	ElidedWidth = AvailableWidth;
+	if (TextFits)
+	{
+		if (!TextFitted)
+		{
+			_this->QLabel::setText(Text);
+		}
+		return;
+	}
+
+	ElidedTextKey Key{Text, _this->font().key(), AvailableWidth, ElideMode};
+	auto& Cache = elidedTextCache();
+	QString* CachedText = Cache.object(Key);
+	if (!CachedText)
+	{
+		QFontMetrics fm = _this->fontMetrics();
+		QString str = fm.elidedText(Text, ElideMode, AvailableWidth);
+		if (str == "…")
+		{
+			str = Text.at(0);
+		}
+		CachedText = new QString(str);
+		Cache.insert(Key, CachedText);
+	}
+	_this->QLabel::setText(*CachedText);
 }
 
 
@@ -112,6 +203,7 @@ Qt::TextElideMode CElidingLabel::elideMode() const
 void CElidingLabel::setElideMode(Qt::TextElideMode mode)
 {
 	d->ElideMode = mode;
+	d->invalidate();
 	d->elideText(size().width());
 }
 
@@ -149,6 +241,18 @@ void CElidingLabel::resizeEvent(QResizeEvent *event)
 }
 
 
+//============================================================================
+void CElidingLabel::changeEvent(QEvent* event)
+{
+	Super::changeEvent(event);
+	if (event->type() == QEvent::FontChange)
+	{
+		d->invalidate();
+		d->elideText(size().width());
+	}
+}
+
+
 //============================================================================
 QSize CElidingLabel::minimumSizeHint() const
 {
@@ -169,8 +273,7 @@ QSize CElidingLabel::sizeHint() const
     {
         return QLabel::sizeHint();
     }
-    const QFontMetrics& fm = fontMetrics();
-    QSize size(fm.width(d->Text), QLabel::sizeHint().height());
+    QSize size(d->textWidth(), QLabel::sizeHint().height());
 	return size;
 }
 
@@ -184,7 +287,12 @@ void CElidingLabel::setText(const QString &text)
 	}
 	else
 	{
+		if (d->Text == text)
+		{
+			return;
+		}
 		d->Text = text;
+		d->invalidate();
 #ifndef QT_NO_TOOLTIP
 		setToolTip( text );
 #endif
@@ -53,6 +53,11 @@ protected:
     virtual void resizeEvent( QResizeEvent *event ) override;
     virtual void mouseDoubleClickEvent( QMouseEvent *ev ) override;
 
+    /**
+     * Invalidates the cached text width and elided text on font changes
+     */
+    virtual void changeEvent(QEvent* event) override;
+
 public:
     using Super = QLabel;
 
@@ -38,12 +38,14 @@
 #include <QDebug>
 #include <QAbstractButton>
 #include <QElapsedTimer>
+#include <QTimer>
 
 #include "DockContainerWidget.h"
 #include "DockAreaWidget.h"
 #include "DockManager.h"
 #include "DockWidget.h"
 #include "DockOverlay.h"
+#include "DockInstrumentation.h"
 
 #ifdef Q_OS_LINUX
 #include "linux/FloatingWidgetTitleBar.h"
@@ -67,6 +69,11 @@ struct FloatingDockContainerPrivate
 	QPoint DragStartMousePosition;
 	CDockContainerWidget* DropContainer = nullptr;
 	CDockAreaWidget* SingleDockArea = nullptr;
+	QTimer* DragUpdateTimer = nullptr;
+	QElapsedTimer LastDragUpdate;
+	bool MoveRequested = false;
+	bool DropOverlaysUpdated = false;
+	QPoint DropOverlaysCursorPos;
 #ifdef Q_OS_LINUX
     QWidget* MouseEventHandler = nullptr;
     CFloatingWidgetTitleBar* TitleBar = nullptr;
@@ -80,6 +87,40 @@ struct FloatingDockContainerPrivate
 	void titleMouseReleaseEvent();
 	void updateDropOverlays(const QPoint& GlobalPos);
 
+	/**
+	 * Moves the floating widget to the current cursor position relative to
+	 * the drag start position
+	 */
+	void moveToCursor();
+
+	/**
+	 * Requests a drag update. If Move is true, the floating widget is moved
+	 * to the current cursor position. The update is processed immediately,
+	 * if the last update is older than the update interval configured in the
+	 * dock manager. Otherwise it is merged with all other requests that
+	 * arrive until the interval has elapsed.
+	 */
+	void requestDragUpdate(bool Move);
+
+	/**
+	 * Processes the pending drag update - that means it moves the floating
+	 * widget if requested and updates the drop overlays for the current
+	 * cursor position
+	 */
+	void processDragUpdate();
+
+	/**
+	 * Processes a pending drag update immediately. This is required before
+	 * the drop target is evaluated on mouse release
+	 */
+	void flushDragUpdate()
+	{
+		if (DragUpdateTimer->isActive())
+		{
+			processDragUpdate();
+		}
+	}
+
 	/**
 	 * Tests is a certain state is active
 	 */
@@ -90,6 +131,16 @@ struct FloatingDockContainerPrivate
 
 	void setState(eDragState StateId)
 	{
+		// Other windows may have been moved since the last drag operation.
+		// The cached container geometries are updated once if a new drag
+		// operation starts and once when it ends, because the dragged
+		// window may cover other dock widgets now
+		if ((DraggingInactive == DraggingState) != (DraggingInactive == StateId)
+		 && DockManager)
+		{
+			DockManager->invalidateDockContainerOrder();
+			DropOverlaysUpdated = false;
+		}
 		DraggingState = StateId;
 	}
 
@@ -118,6 +169,7 @@ FloatingDockContainerPrivate::FloatingDockContainerPrivate(CFloatingDockContaine
 //============================================================================
 void FloatingDockContainerPrivate::titleMouseReleaseEvent()
 {
+	flushDragUpdate();
 	setState(DraggingInactive);
 	if (!DropContainer)
 	{
@@ -154,6 +206,65 @@ void FloatingDockContainerPrivate::titleMouseReleaseEvent()
 
 
 
+//============================================================================
+void FloatingDockContainerPrivate::moveToCursor()
+{
+	int BorderSize = (_this->frameSize().width() - _this->size().width()) / 2;
+	const QPoint moveToPos = QCursor::pos() - DragStartMousePosition - QPoint(BorderSize, 0);
+	_this->move(moveToPos);
+}
+
+
+//============================================================================
+void FloatingDockContainerPrivate::requestDragUpdate(bool Move)
+{
+	MoveRequested = MoveRequested || Move;
+	int UpdateRate = DockManager ? DockManager->maxDragUpdateRate() : 0;
+	int Interval = (UpdateRate > 0) ? (1000 / UpdateRate) : 0;
+	qint64 Elapsed = LastDragUpdate.isValid() ? LastDragUpdate.elapsed() : Interval;
+	if (Elapsed >= Interval)
+	{
+		processDragUpdate();
+	}
+	else if (!DragUpdateTimer->isActive())
+	{
+		DragUpdateTimer->start(Interval - Elapsed);
+	}
+}
+
+
+//============================================================================
+void FloatingDockContainerPrivate::processDragUpdate()
+{
+	ADS_INSTRUMENT_SCOPE(DragUpdate);
+	DragUpdateTimer->stop();
+	LastDragUpdate.start();
+	if (MoveRequested)
+	{
+		MoveRequested = false;
+		moveToCursor();
+	}
+
+	if (!isState(DraggingFloatingWidget))
+	{
+		return;
+	}
+
+	// The move of the floating widget causes a move event that requests
+	// another update - we ignore it if the cursor did not move in the
+	// meantime
+	QPoint CursorPos = QCursor::pos();
+	if (DropOverlaysUpdated && CursorPos == DropOverlaysCursorPos)
+	{
+		return;
+	}
+
+	DropOverlaysUpdated = true;
+	DropOverlaysCursorPos = CursorPos;
+	updateDropOverlays(CursorPos);
+}
+
+
 //============================================================================
 void FloatingDockContainerPrivate::updateDropOverlays(const QPoint& GlobalPos)
 {
@@ -162,30 +273,8 @@ void FloatingDockContainerPrivate::updateDropOverlays(const QPoint& GlobalPos)
 		return;
 	}
 
-    auto Containers = DockManager->dockContainers();
-    CDockContainerWidget* TopContainer = nullptr;
-    for (auto ContainerWidget : Containers)
-    {
-    	if (!ContainerWidget->isVisible())
-    	{
-    		continue;
-    	}
-
-    	if (DockContainer == ContainerWidget)
-    	{
-    		continue;
-    	}
-
-    	QPoint MappedPos = ContainerWidget->mapFromGlobal(GlobalPos);
-    	if (ContainerWidget->rect().contains(MappedPos))
-    	{
-    		if (!TopContainer || ContainerWidget->isInFrontOf(TopContainer))
-    		{
-    			TopContainer = ContainerWidget;
-    		}
-    	}
-    }
-
+    CDockContainerWidget* TopContainer = DockManager->dockContainerAt(GlobalPos,
+    	DockContainer);
     DropContainer = TopContainer;
     auto ContainerOverlay = DockManager->containerOverlay();
     auto DockAreaOverlay = DockManager->dockAreaOverlay();
@@ -200,7 +289,7 @@ void FloatingDockContainerPrivate::updateDropOverlays(const QPoint& GlobalPos)
     int VisibleDockAreas = TopContainer->visibleDockAreaCount();
     ContainerOverlay->setAllowedAreas(VisibleDockAreas > 1 ?
     	OuterDockAreas : AllDockAreas);
-	DockWidgetArea ContainerArea = ContainerOverlay->showOverlay(TopContainer);
+	DockWidgetArea ContainerArea = ContainerOverlay->showOverlay(TopContainer, GlobalPos);
 	ContainerOverlay->enableDropPreview(ContainerArea != InvalidDockWidgetArea);
     auto DockArea = TopContainer->dockAreaAt(GlobalPos);
     if (DockArea && DockArea->isVisible() && VisibleDockAreas > 0)
@@ -208,7 +297,7 @@ void FloatingDockContainerPrivate::updateDropOverlays(const QPoint& GlobalPos)
     	DockAreaOverlay->enableDropPreview(true);
     	DockAreaOverlay->setAllowedAreas((VisibleDockAreas == 1) ?
     		NoDockWidgetArea : AllDockAreas);
-        DockWidgetArea Area = DockAreaOverlay->showOverlay(DockArea);
+        DockWidgetArea Area = DockAreaOverlay->showOverlay(DockArea, GlobalPos);
 
         // A CenterDockWidgetArea for the dockAreaOverlay() indicates that
         // the mouse is in the title bar. If the ContainerArea is valid
@@ -236,7 +325,11 @@ CFloatingDockContainer::CFloatingDockContainer(CDockManager* DockManager) :
     tFloatingWidgetBase(DockManager),
 	d(new FloatingDockContainerPrivate(this))
 {
+    ADS_INSTRUMENT_COUNT(WidgetsCreated);
     d->DockManager = DockManager;
+    d->DragUpdateTimer = new QTimer(this);
+    d->DragUpdateTimer->setSingleShot(true);
+    connect(d->DragUpdateTimer, &QTimer::timeout, this, [this]() { d->processDragUpdate(); });
     d->DockContainer = new CDockContainerWidget(DockManager, this);
     connect(d->DockContainer, SIGNAL(dockAreasAdded()), this, SLOT(onDockAreasAddedOrRemoved()));
     connect(d->DockContainer, SIGNAL(dockAreasRemoved()), this, SLOT(onDockAreasAddedOrRemoved()));
@@ -292,7 +385,7 @@ CFloatingDockContainer::CFloatingDockContainer(CDockWidget* DockWidget) :
 //============================================================================
 CFloatingDockContainer::~CFloatingDockContainer()
 {
-	qDebug() << "~CFloatingDockContainer";
+	ADS_PRINT("~CFloatingDockContainer");
 	if (d->DockManager)
 	{
 		d->DockManager->removeFloatingWidget(this);
@@ -312,9 +405,16 @@ CDockContainerWidget* CFloatingDockContainer::dockContainer() const
 void CFloatingDockContainer::changeEvent(QEvent *event)
 {
 	QWidget::changeEvent(event);
+	if (event->type() == QEvent::WindowStateChange && d->DockManager)
+	{
+		// Minimizing or restoring the floating widget changes the
+		// visibility of all dock widgets in this and in other containers
+		d->DockManager->invalidateDockContainerOrder();
+	}
+
 	if ((event->type() == QEvent::ActivationChange) && isActiveWindow())
     {
-		qDebug() << "FloatingWidget::changeEvent QEvent::ActivationChange ";
+		ADS_PRINT("FloatingWidget::changeEvent QEvent::ActivationChange ");
 		d->zOrderIndex = ++zOrderCounter;
         return;
     }
@@ -329,13 +429,21 @@ void CFloatingDockContainer::moveEvent(QMoveEvent *event)
 	{
 	case DraggingMousePressed:
 		 d->setState(DraggingFloatingWidget);
-		 d->updateDropOverlays(QCursor::pos());
+		 d->requestDragUpdate(false);
 		 break;
 
 	case DraggingFloatingWidget:
-		 d->updateDropOverlays(QCursor::pos());
+		 d->requestDragUpdate(false);
 		 break;
+
 	default:
+		// The dock container in this window does not receive a move event.
+		// While the window is dragged, the cached geometries are updated
+		// when the drag ends
+		if (d->DockManager)
+		{
+			d->DockManager->invalidateDockContainerOrder();
+		}
 		break;
     }
 }
@@ -344,7 +452,7 @@ void CFloatingDockContainer::moveEvent(QMoveEvent *event)
 //============================================================================
 void CFloatingDockContainer::closeEvent(QCloseEvent *event)
 {
-    qDebug() << "CFloatingDockContainer closeEvent";
+    ADS_PRINT("CFloatingDockContainer closeEvent");
 	d->setState(DraggingInactive);
 
     if (isClosable())
@@ -380,6 +488,7 @@ void CFloatingDockContainer::closeEvent(QCloseEvent *event)
 void CFloatingDockContainer::hideEvent(QHideEvent *event)
 {
 	Super::hideEvent(event);
+	d->DockContainer->beginCompactionBatch();
 	for (auto DockArea : d->DockContainer->openedDockAreas())
 	{
 		for (auto DockWidget : DockArea->openedDockWidgets())
@@ -387,6 +496,7 @@ void CFloatingDockContainer::hideEvent(QHideEvent *event)
 			DockWidget->toggleView(false);
 		}
 	}
+	d->DockContainer->endCompactionBatch();
 }
 
 
@@ -414,13 +524,13 @@ bool CFloatingDockContainer::event(QEvent *e)
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 2))
 		if (e->type() == QEvent::NonClientAreaMouseButtonPress /*&& QGuiApplication::mouseButtons().testFlag(Qt::LeftButton)*/)
 		{
-			qDebug() << "FloatingWidget::event Event::NonClientAreaMouseButtonPress" << e->type();
+			ADS_PRINT("FloatingWidget::event Event::NonClientAreaMouseButtonPress" << e->type());
 			d->setState(DraggingMousePressed);
 		}
 #else
 		if (e->type() == QEvent::NonClientAreaMouseButtonPress && QGuiApplication::mouseButtons().testFlag(Qt::LeftButton))
 		{
-			qDebug() << "FloatingWidget::event Event::NonClientAreaMouseButtonPress" << e->type();
+			ADS_PRINT("FloatingWidget::event Event::NonClientAreaMouseButtonPress" << e->type());
 			d->setState(DraggingMousePressed);
 		}
 #endif
@@ -431,7 +541,7 @@ bool CFloatingDockContainer::event(QEvent *e)
 		switch (e->type())
 		{
 		case QEvent::NonClientAreaMouseButtonDblClick:
-			 qDebug() << "FloatingWidget::event QEvent::NonClientAreaMouseButtonDblClick";
+			 ADS_PRINT("FloatingWidget::event QEvent::NonClientAreaMouseButtonDblClick");
 			 d->setState(DraggingInactive);
 			 break;
 
@@ -458,7 +568,7 @@ bool CFloatingDockContainer::event(QEvent *e)
 	case DraggingFloatingWidget:
 		if (e->type() == QEvent::NonClientAreaMouseButtonRelease)
 		{
-			qDebug() << "FloatingWidget::event QEvent::NonClientAreaMouseButtonRelease";
+			ADS_PRINT("FloatingWidget::event QEvent::NonClientAreaMouseButtonRelease");
 			d->titleMouseReleaseEvent();
 		}
 	break;
@@ -468,19 +578,31 @@ bool CFloatingDockContainer::event(QEvent *e)
 	}
 
 #if (ADS_DEBUG_LEVEL > 0)
-	qDebug() << "CFloatingDockContainer::event " << e->type();
+	ADS_PRINT("CFloatingDockContainer::event " << e->type());
 #endif
 	return QWidget::event(e);
 }
 
 
+//============================================================================
+void CFloatingDockContainer::setVisible(bool visible)
+{
+	if (d->DockManager && d->DockManager->isFloatingWidgetShowDeferred())
+	{
+		return;
+	}
+
+	tFloatingWidgetBase::setVisible(visible);
+}
+
+
 //============================================================================
 bool CFloatingDockContainer::eventFilter(QObject *watched, QEvent *event)
 {
     Q_UNUSED(watched);
     if (event->type() == QEvent::MouseButtonRelease && d->isState(DraggingFloatingWidget))
 	{
-		qDebug() << "FloatingWidget::eventFilter QEvent::MouseButtonRelease";
+		ADS_PRINT("FloatingWidget::eventFilter QEvent::MouseButtonRelease");
         finishDragging();
 		d->titleMouseReleaseEvent();
     }
@@ -511,7 +633,7 @@ void CFloatingDockContainer::startFloating(const QPoint& DragStartMousePos, cons
        }
    }
 #endif
-	moveFloating();
+	d->moveToCursor();
     show();
 
 }
@@ -520,9 +642,7 @@ void CFloatingDockContainer::startFloating(const QPoint& DragStartMousePos, cons
 //============================================================================
 void CFloatingDockContainer::moveFloating()
 {
-	int BorderSize = (frameSize().width() - size().width()) / 2;
-	const QPoint moveToPos = QCursor::pos() - d->DragStartMousePosition - QPoint(BorderSize, 0);
-    move(moveToPos);
+	d->requestDragUpdate(true);
 }
 
 
@@ -536,7 +656,7 @@ bool CFloatingDockContainer::isClosable() const
 //============================================================================
 void CFloatingDockContainer::onDockAreasAddedOrRemoved()
 {
-	qDebug() << "CFloatingDockContainer::onDockAreasAddedOrRemoved()";
+	ADS_PRINT("CFloatingDockContainer::onDockAreasAddedOrRemoved()");
 	auto TopLevelDockArea = d->DockContainer->topLevelDockArea();
 	if (TopLevelDockArea)
 	{
@@ -582,15 +702,11 @@ void CFloatingDockContainer::onDockAreaCurrentChanged(int Index)
 
 
 //============================================================================
-bool CFloatingDockContainer::restoreState(QXmlStreamReader& Stream, bool Testing)
+void CFloatingDockContainer::restoreState(const internal::DockingState& State,
+	const internal::ContainerState& Container)
 {
-	if (!d->DockContainer->restoreState(Stream, Testing))
-	{
-		return false;
-	}
-
+	d->DockContainer->restoreState(State, Container);
 	onDockAreasAddedOrRemoved();
-	return true;
 }
 
 
@@ -619,7 +735,7 @@ QList<CDockWidget*> CFloatingDockContainer::dockWidgets() const
 //============================================================================
 void CFloatingDockContainer::finishDragging()
 {
-    qDebug() << "CFloatingDockContainer::finishDragging";
+    ADS_PRINT("CFloatingDockContainer::finishDragging");
 #ifdef Q_OS_LINUX
    setAttribute(Qt::WA_X11NetWmWindowTypeDock, false);
    setWindowOpacity(1);
@@ -39,10 +39,13 @@
 #define tFloatingWidgetBase QWidget
 #endif
 
-class QXmlStreamReader;
-
 namespace ads
 {
+namespace internal
+{
+struct DockingState;
+struct ContainerState;
+}
 struct FloatingDockContainerPrivate;
 class CDockManager;
 struct DockManagerPrivate;
@@ -57,12 +60,41 @@ class CDockAreaTitleBar;
 struct DockAreaTitleBarPrivate;
 class CFloatingWidgetTitleBar;
 
+/**
+ * Pure virtual interface for all widgets that follow the mouse cursor while
+ * a dock widget or dock area is dragged.
+ * This is the real floating dock container or the lightweight drag preview
+ * \see CFloatingDragPreview
+ */
+class IFloatingWidget
+{
+public:
+	virtual ~IFloatingWidget() = default;
+
+	/**
+	 * Starts floating.
+	 * This function should get called typically from a mouse press event
+	 * handler
+	 */
+	virtual void startFloating(const QPoint& DragStartMousePos, const QSize& Size,
+        eDragState DragState, QWidget* MouseEventHandler) = 0;
+
+	/**
+	 * Moves the widget to a new position relative to the position given when
+	 * startFloating() was called.
+	 * This function should be called from a mouse mouve event handler to
+	 * move the floating widget on mouse move events.
+	 */
+	virtual void moveFloating() = 0;
+};
+
+
 /**
  * This implements a floating widget that is a dock container that accepts
  * docking of dock widgets like the main window and that can be docked into
  * another dock container
  */
-class ADS_EXPORT CFloatingDockContainer : public tFloatingWidgetBase
+class ADS_EXPORT CFloatingDockContainer : public tFloatingWidgetBase, public IFloatingWidget
 {
 	Q_OBJECT
 private:
@@ -89,8 +121,8 @@ protected:
 	 * Use moveToGlobalPos() to move the widget to a new position
 	 * depending on the start position given in Pos parameter
 	 */
-	void startFloating(const QPoint& DragStartMousePos, const QSize& Size,
-        eDragState DragState, QWidget* MouseEventHandler);
+	virtual void startFloating(const QPoint& DragStartMousePos, const QSize& Size,
+        eDragState DragState, QWidget* MouseEventHandler) override;
 
 	/**
 	 * Call this function to start dragging the floating widget
@@ -118,17 +150,18 @@ protected:
 
 	/**
 	 * Moves the widget to a new position relative to the position given when
-	 * startFloating() was called
+	 * startFloating() was called.
+	 * Moves are throttled to the maximum drag update rate of the dock manager.
+	 * Fast mouse moves are merged and the widget is moved to the latest
+	 * cursor position.
 	 */
-	void moveFloating();
+	virtual void moveFloating() override;
 
 	/**
-	 * Restores the state from given stream.
-	 * If Testing is true, the function only parses the data from the given
-	 * stream but does not restore anything. You can use this check for
-	 * faulty files before you start restoring the state
+	 * Restores the state of the given container from the decoded state tree
 	 */
-	bool restoreState(QXmlStreamReader& Stream, bool Testing);
+	void restoreState(const internal::DockingState& State,
+		const internal::ContainerState& Container);
 
 	/**
 	 * Call this function to update the window title
@@ -145,6 +178,14 @@ protected: // reimplements QWidget
 	virtual void showEvent(QShowEvent *event) override;
 	virtual bool eventFilter(QObject *watched, QEvent *event) override;
 
+public: // reimplements QWidget
+	/**
+	 * While the dock manager restores a state, show and hide requests are
+	 * ignored. The dock manager shows all floating widgets in one pass, when
+	 * the restored state is shown
+	 */
+	virtual void setVisible(bool visible) override;
+
 public:
 	using Super = QWidget;
 
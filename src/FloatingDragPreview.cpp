@@ -0,0 +1,376 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   FloatingDragPreview.cpp
+/// \date   14.10.2026
+/// \brief  Implementation of CFloatingDragPreview class
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "FloatingDragPreview.h"
+
+#include <QApplication>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QPixmap>
+#include <QPointer>
+
+#include "DockAreaWidget.h"
+#include "DockContainerWidget.h"
+#include "DockInstrumentation.h"
+#include "DockManager.h"
+#include "DockOverlay.h"
+#include "DockWidget.h"
+
+namespace ads
+{
+/**
+ * Private data class of CFloatingDragPreview class (pimpl)
+ */
+struct FloatingDragPreviewPrivate
+{
+	CFloatingDragPreview* _this;
+	QWidget* Content;
+	CDockWidget* ContentDockWidget = nullptr;
+	CDockAreaWidget* ContentDockArea = nullptr;
+	QPointer<CDockManager> DockManager;
+	QPoint DragStartMousePosition;
+	QPixmap ContentPreviewPixmap;
+	QPointer<CDockContainerWidget> DropContainer;
+	QPointer<CDockAreaWidget> DropTargetArea;
+	DockWidgetArea DropArea = InvalidDockWidgetArea;
+	bool Canceled = false;
+
+	/**
+	 * Private data constructor
+	 */
+	FloatingDragPreviewPrivate(CFloatingDragPreview* _public);
+
+	/**
+	 * Returns the dock container that currently contains the dragged content
+	 */
+	CDockContainerWidget* contentDockContainer() const
+	{
+		return ContentDockWidget ? ContentDockWidget->dockContainer()
+			: ContentDockArea->dockContainer();
+	}
+
+	/**
+	 * Shows the drop overlays for the given cursor position and stores the
+	 * drop target that will be used, if the mouse is released at this
+	 * position
+	 */
+	void updateDropOverlays(const QPoint& GlobalPos);
+
+	/**
+	 * Hides both drop overlays
+	 */
+	void hideDropOverlays();
+
+	/**
+	 * Moves the dragged content into its final place - either into the drop
+	 * target or into a new floating dock container at the position of the
+	 * preview
+	 */
+	void dropContent();
+
+	/**
+	 * Finishes dragging and deletes the preview
+	 */
+	void finishDragging();
+
+	/**
+	 * Cancels dragging. The content stays in its current dock area
+	 */
+	void cancelDragging();
+};
+// struct FloatingDragPreviewPrivate
+
+
+//============================================================================
+FloatingDragPreviewPrivate::FloatingDragPreviewPrivate(CFloatingDragPreview* _public) :
+	_this(_public)
+{
+
+}
+
+
+//============================================================================
+void FloatingDragPreviewPrivate::updateDropOverlays(const QPoint& GlobalPos)
+{
+	DropContainer = nullptr;
+	DropTargetArea = nullptr;
+	DropArea = InvalidDockWidgetArea;
+	if (!_this->isVisible() || !DockManager)
+	{
+		return;
+	}
+
+	CDockContainerWidget* TopContainer = DockManager->dockContainerAt(GlobalPos);
+	DropContainer = TopContainer;
+	auto ContainerOverlay = DockManager->containerOverlay();
+	auto DockAreaOverlay = DockManager->dockAreaOverlay();
+
+	if (!TopContainer)
+	{
+		hideDropOverlays();
+		return;
+	}
+
+	// A dragged dock area is still visible in its container, but it will
+	// be removed from the container, when it is dropped
+	int VisibleDockAreas = TopContainer->visibleDockAreaCount();
+	if (ContentDockArea && ContentDockArea->dockContainer() == TopContainer)
+	{
+		--VisibleDockAreas;
+	}
+
+	ContainerOverlay->setAllowedAreas(VisibleDockAreas > 1 ?
+		OuterDockAreas : AllDockAreas);
+	DockWidgetArea ContainerArea = ContainerOverlay->showOverlay(TopContainer, GlobalPos);
+	ContainerOverlay->enableDropPreview(ContainerArea != InvalidDockWidgetArea);
+	DropArea = ContainerArea;
+	auto DockArea = TopContainer->dockAreaAt(GlobalPos);
+	if (DockArea && DockArea->isVisible() && VisibleDockAreas > 0
+	 && DockArea != ContentDockArea)
+	{
+		DockAreaOverlay->enableDropPreview(true);
+		DockAreaOverlay->setAllowedAreas((VisibleDockAreas == 1) ?
+			NoDockWidgetArea : AllDockAreas);
+		DockWidgetArea Area = DockAreaOverlay->showOverlay(DockArea, GlobalPos);
+
+		// A CenterDockWidgetArea for the dockAreaOverlay() indicates that
+		// the mouse is in the title bar. If the ContainerArea is valid
+		// then we ignore the dock area of the dockAreaOverlay() and disable
+		// the drop preview
+		if ((Area == CenterDockWidgetArea) && (ContainerArea != InvalidDockWidgetArea))
+		{
+			DockAreaOverlay->enableDropPreview(false);
+			ContainerOverlay->enableDropPreview(true);
+		}
+		else
+		{
+			ContainerOverlay->enableDropPreview(InvalidDockWidgetArea == Area);
+		}
+
+		// Same rule as in CDockContainerWidget::dropFloatingWidget()
+		if (Area != InvalidDockWidgetArea
+		 && (ContainerArea == InvalidDockWidgetArea || ContainerArea == Area))
+		{
+			DropTargetArea = DockArea;
+			DropArea = Area;
+		}
+	}
+	else
+	{
+		DockAreaOverlay->hideOverlay();
+	}
+}
+
+
+//============================================================================
+void FloatingDragPreviewPrivate::hideDropOverlays()
+{
+	if (!DockManager)
+	{
+		return;
+	}
+
+	DockManager->containerOverlay()->hideOverlay();
+	DockManager->dockAreaOverlay()->hideOverlay();
+}
+
+
+//============================================================================
+void FloatingDragPreviewPrivate::dropContent()
+{
+	if (!DockManager)
+	{
+		return;
+	}
+
+	CFloatingDockContainer* FloatingWidget = ContentDockWidget
+		? new CFloatingDockContainer(ContentDockWidget)
+		: new CFloatingDockContainer(ContentDockArea);
+	if (DropContainer && DropArea != InvalidDockWidgetArea)
+	{
+		// The floating widget is never shown - it is only used to transport
+		// the content into the drop target
+		DropContainer->dropFloatingWidget(FloatingWidget, DropTargetArea, DropArea);
+		return;
+	}
+
+	FloatingWidget->resize(_this->size());
+	FloatingWidget->move(_this->pos());
+	FloatingWidget->show();
+	auto TopLevelDockWidget = FloatingWidget->topLevelDockWidget();
+	if (TopLevelDockWidget)
+	{
+		TopLevelDockWidget->emitTopLevelChanged(true);
+	}
+}
+
+
+//============================================================================
+void FloatingDragPreviewPrivate::finishDragging()
+{
+	ADS_PRINT("CFloatingDragPreview::finishDragging");
+	qApp->removeEventFilter(_this);
+	hideDropOverlays();
+	_this->hide();
+	if (!Canceled)
+	{
+		dropContent();
+	}
+	_this->deleteLater();
+}
+
+
+//============================================================================
+void FloatingDragPreviewPrivate::cancelDragging()
+{
+	ADS_PRINT("CFloatingDragPreview::cancelDragging");
+	Canceled = true;
+	_this->hide();
+	hideDropOverlays();
+}
+
+
+//============================================================================
+CFloatingDragPreview::CFloatingDragPreview(QWidget* Content, QWidget* parent) :
+	QWidget(parent),
+	d(new FloatingDragPreviewPrivate(this))
+{
+	d->Content = Content;
+	setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
+	setWindowOpacity(0.6);
+}
+
+
+//============================================================================
+CFloatingDragPreview::CFloatingDragPreview(CDockWidget* Content) :
+	CFloatingDragPreview(Content, Content->dockManager())
+{
+	d->ContentDockWidget = Content;
+	d->DockManager = Content->dockManager();
+}
+
+
+//============================================================================
+CFloatingDragPreview::CFloatingDragPreview(CDockAreaWidget* Content) :
+	CFloatingDragPreview(Content, Content->dockManager())
+{
+	d->ContentDockArea = Content;
+	d->DockManager = Content->dockManager();
+}
+
+
+//============================================================================
+CFloatingDragPreview::~CFloatingDragPreview()
+{
+	ADS_PRINT("~CFloatingDragPreview");
+	delete d;
+}
+
+
+//============================================================================
+void CFloatingDragPreview::startFloating(const QPoint& DragStartMousePos,
+	const QSize& Size, eDragState DragState, QWidget* MouseEventHandler)
+{
+	Q_UNUSED(DragState)
+	Q_UNUSED(MouseEventHandler)
+	resize(Size);
+	d->DragStartMousePosition = DragStartMousePos;
+	// The snapshot is taken once - the preview never paints the real content
+	d->ContentPreviewPixmap = d->Content->grab();
+	if (d->DockManager)
+	{
+		d->DockManager->invalidateDockContainerOrder();
+	}
+	move(QCursor::pos() - d->DragStartMousePosition);
+	show();
+	d->updateDropOverlays(QCursor::pos());
+
+	// We receive the mouse release and the escape key via the application
+	// event filter because the mouse is grabbed by the tab or title bar
+	// that started dragging
+	qApp->installEventFilter(this);
+}
+
+
+//============================================================================
+void CFloatingDragPreview::moveFloating()
+{
+	if (d->Canceled)
+	{
+		return;
+	}
+
+	ADS_INSTRUMENT_SCOPE(DragUpdate);
+	move(QCursor::pos() - d->DragStartMousePosition);
+	d->updateDropOverlays(QCursor::pos());
+}
+
+
+//============================================================================
+bool CFloatingDragPreview::eventFilter(QObject* watched, QEvent* event)
+{
+	Q_UNUSED(watched);
+	if (event->type() == QEvent::MouseButtonRelease)
+	{
+		ADS_PRINT("CFloatingDragPreview::eventFilter QEvent::MouseButtonRelease");
+		d->finishDragging();
+	}
+	else if (event->type() == QEvent::KeyPress && !d->Canceled)
+	{
+		QKeyEvent* e = static_cast<QKeyEvent*>(event);
+		if (e->key() == Qt::Key_Escape)
+		{
+			d->cancelDragging();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//============================================================================
+void CFloatingDragPreview::paintEvent(QPaintEvent* event)
+{
+	Q_UNUSED(event);
+	QPainter painter(this);
+	painter.drawPixmap(0, 0, d->ContentPreviewPixmap);
+	QColor Color = palette().color(QPalette::Active, QPalette::Highlight);
+	QPen Pen = painter.pen();
+	Pen.setColor(Color.darker(120));
+	Pen.setStyle(Qt::SolidLine);
+	Pen.setWidth(1);
+	Pen.setCosmetic(true);
+	painter.setPen(Pen);
+	painter.drawRect(rect().adjusted(0, 0, -1, -1));
+}
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF FloatingDragPreview.cpp
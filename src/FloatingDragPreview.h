@@ -0,0 +1,110 @@
+#ifndef FloatingDragPreviewH
+#define FloatingDragPreviewH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   FloatingDragPreview.h
+/// \date   14.10.2026
+/// \brief  Declaration of CFloatingDragPreview class
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include <QWidget>
+
+#include "FloatingDockContainer.h"
+
+namespace ads
+{
+class CDockWidget;
+class CDockAreaWidget;
+struct FloatingDragPreviewPrivate;
+
+/**
+ * A lightweight preview window that follows the mouse cursor while a dock
+ * widget or dock area is dragged, if the CDockManager::GhostDragPreview flag
+ * is set.
+ * The dragged content stays in its dock area while it is dragged. The
+ * preview only shows a snapshot of the content. On release, the content is
+ * dropped into the dock container under the cursor or is moved into a new
+ * floating dock container, if there is no drop target.
+ * The preview deletes itself when dragging has finished.
+ */
+class ADS_EXPORT CFloatingDragPreview : public QWidget, public IFloatingWidget
+{
+	Q_OBJECT
+private:
+	FloatingDragPreviewPrivate* d; ///< private data (pimpl)
+	friend struct FloatingDragPreviewPrivate;
+
+protected:
+	/**
+	 * Creates the preview for the given content widget
+	 */
+	CFloatingDragPreview(QWidget* Content, QWidget* parent);
+
+protected: // reimplements QWidget
+	virtual void paintEvent(QPaintEvent *e) override;
+
+public:
+	using Super = QWidget;
+
+	/**
+	 * Creates a preview for dragging the given dock widget
+	 */
+	CFloatingDragPreview(CDockWidget* Content);
+
+	/**
+	 * Creates a preview for dragging the given dock area
+	 */
+	CFloatingDragPreview(CDockAreaWidget* Content);
+
+	/**
+	 * Virtual Destructor
+	 */
+	virtual ~CFloatingDragPreview();
+
+	/**
+	 * Shows the preview at the current cursor position and starts
+	 * tracking the mouse.
+	 * DragState and MouseEventHandler are ignored - the preview is always
+	 * in the DraggingFloatingWidget state
+	 */
+	virtual void startFloating(const QPoint& DragStartMousePos, const QSize& Size,
+        eDragState DragState, QWidget* MouseEventHandler) override;
+
+	/**
+	 * Moves the preview to the current cursor position and updates the drop
+	 * overlays
+	 */
+	virtual void moveFloating() override;
+
+	/**
+	 * Handles the mouse release that finishes dragging and the escape key
+	 * that cancels dragging
+	 */
+	virtual bool eventFilter(QObject* watched, QEvent* event) override;
+}; // class CFloatingDragPreview
+} // namespace ads
+
+//---------------------------------------------------------------------------
+#endif // FloatingDragPreviewH
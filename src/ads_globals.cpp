@@ -37,6 +37,7 @@
 
 namespace ads
 {
+Q_LOGGING_CATEGORY(adsLog, "ads")
 
 namespace internal
 {
@@ -34,6 +34,7 @@
 #include <QtCore/QtGlobal>
 #include <QPixmap>
 #include <QWidget>
+#include <QLoggingCategory>
 
 #ifndef ADS_STATIC
 #ifdef ADS_SHARED_EXPORT
@@ -47,10 +48,23 @@
 
 #define ADS_DEBUG_LEVEL 0
 
+// The debug output of the library is printed to the "ads" logging category.
+// In release builds, the output is removed completely unless the library is
+// compiled with ADS_DEBUG_PRINT
+#if defined(QT_NO_DEBUG) && !defined(ADS_DEBUG_PRINT)
+#define ADS_PRINT_ENABLED 0
+#define ADS_PRINT(s)
+#else
+#define ADS_PRINT_ENABLED 1
+#define ADS_PRINT(s) qCDebug(ads::adsLog) << s
+#endif
+
 class QSplitter;
 
 namespace ads
 {
+Q_DECLARE_LOGGING_CATEGORY(adsLog)
+
 class CDockSplitter;
 
 enum DockWidgetArea
@@ -92,6 +106,23 @@ namespace internal
 static const bool RestoreTesting = true;
 static const bool Restore = false;
 
+/**
+ * Magic number and format version of the binary state format that is
+ * written if the CDockManager::BinaryStateFormat config flag is set
+ */
+static const quint32 BinaryStateMagic = 0x41445342; // "ADSB"
+static const quint32 BinaryStateFormatVersion = 1;
+
+/**
+ * Node tags of the binary state format
+ */
+enum eStateNodeTag
+{
+	StateEmptyNode = 0,
+	StateSplitterNode = 1,
+	StateAreaNode = 2
+};
+
 /**
  * Replace the from widget in the given splitter with the To widget
  */
@@ -40,7 +40,10 @@ HEADERS += \
     DockOverlay.h \
     DockSplitter.h \
     DockAreaTitleBar.h \
-    ElidingLabel.h
+    ElidingLabel.h \
+    DockLayoutState.h \
+    DockInstrumentation.h \
+    FloatingDragPreview.h
 
 
 SOURCES += \
@@ -55,7 +58,10 @@ SOURCES += \
     DockOverlay.cpp \
     DockSplitter.cpp \
     DockAreaTitleBar.cpp \
-    ElidingLabel.cpp
+    ElidingLabel.cpp \
+    DockLayoutState.cpp \
+    DockInstrumentation.cpp \
+    FloatingDragPreview.cpp
 
 
 unix {